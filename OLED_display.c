@@ -21,40 +21,47 @@
 
               Set DDRAM Address to 0x49 using SPI MODE #3
 
+   The 10 bit words are clocked out with one GPCLR0/GPSET0 write per
+   edge. MOSI is changed while SCK is low and latched on the rising
+   edge.
+
+   OLED_fb_* draw into a 16x2 shadow framebuffer and OLED_flush sends
+   only the cells that differ from what the display already shows,
+   skipping the DDRAM address command when the next dirty cell is the
+   one the display's address counter points at.
 ----------------------------------------------------------------------*/
 #include "OLED_display.h"
 #include "peripheral.h"
-
-extern void dummy (unsigned int);
+#include "library.h"
+#include "hal.h"
 
 #define SCLK  2
 #define MOSI  3
 #define SSEL  4
 
-void OLED_command(int cmd) {
-    int  command = 0x0000 | cmd;
-    gpioWR(SSEL, 0);
+static char fb[OLED_ROWS][OLED_COLS];		// what should be shown
+static char shown[OLED_ROWS][OLED_COLS];	// what the display holds
+
+static void OLED_write(int word) {
+    gpioCLR(1 << SSEL);
     for(int i=9; i>=0; i--) {
-        gpioWR(SCLK, LOW);
-        gpioWR(MOSI, (command & (1 << i)) >> i);
-        gpioWR(SCLK, HIGH);
+        if(word & (1 << i)) {
+            gpioCLR(1 << SCLK);
+            gpioSET(1 << MOSI);
+        }
+        else gpioCLR((1 << SCLK) | (1 << MOSI));
+        gpioSET(1 << SCLK);
     }
-    gpioWR(MOSI, 0);
-    gpioWR(SSEL, 1);
-    gpioWR(SCLK, 0);
+    gpioSET(1 << SSEL);
+    gpioCLR((1 << MOSI) | (1 << SCLK));
+}
+
+void OLED_command(int cmd) {
+    OLED_write(0x0000 | cmd);
 }
 
 void OLED_putc(int chr) {
-     int data = 0x0200 | chr;
-     gpioWR(SSEL, 0);
-     for(int i=9; i>=0; i--) {
-        gpioWR(SCLK, LOW);
-        gpioWR(MOSI, (data & (1 << i)) >> i);
-        gpioWR(SCLK, HIGH);
-    }
-    gpioWR(MOSI, 0);
-    gpioWR(SSEL, 1);
-    gpioWR(SCLK, 0);
+    OLED_write(0x0200 | (chr & 0xFF));
 }
 
 void OLED_puts(char *s) {
@@ -85,5 +92,43 @@ void OLED_init() {
      
      for(int ra=0; ra<10000; ra++)
 		 __asm__("nop");
+
+     for(int row=0; row<OLED_ROWS; row++)
+        for(int col=0; col<OLED_COLS; col++)
+           fb[row][col] = shown[row][col] = ' ';
+}
+
+//---------------------------------------------------------------------
+//	shadow framebuffer, rows and columns count from 1 like OLED_pos
+//---------------------------------------------------------------------
+void OLED_fb_putc(int row, int col, int chr) {
+    if(row < 1 || row > OLED_ROWS || col < 1 || col > OLED_COLS) return;
+    fb[row-1][col-1] = chr;
+}
+
+void OLED_fb_puts(int row, int col, char *s) {
+    while(*s && col <= OLED_COLS)
+        OLED_fb_putc(row, col++, *s++);
+}
+
+void OLED_fb_clear(void) {
+    memset(fb, ' ', sizeof(fb));
+}
+
+// returns the number of characters sent
+int OLED_flush(void) {
+    int sent = 0;
+    for(int row=0; row<OLED_ROWS; row++) {
+        int cursor = -1;		// column the address counter is at
+        for(int col=0; col<OLED_COLS; col++) {
+            if(fb[row][col] == shown[row][col]) continue;
+            if(cursor != col) OLED_pos(row+1, col+1);
+            OLED_putc(fb[row][col]);
+            shown[row][col] = fb[row][col];
+            cursor = col + 1;
+            sent++;
+        }
+    }
+    return sent;
 }
 
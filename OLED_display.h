@@ -1,6 +1,12 @@
 /**********************************************************************/
 //	OLED_display.h   July 11, 2017
 /**********************************************************************/
+#ifndef OLED_DISPLAY_H
+#define OLED_DISPLAY_H
+
+#define OLED_ROWS 2
+#define OLED_COLS 16
+
 void OLED_command(int);
 
 void OLED_putc(int);
@@ -10,3 +16,13 @@ void OLED_puts(char *);
 void OLED_pos(int, int);
 
 void OLED_init();
+
+void OLED_fb_putc(int, int, int);
+
+void OLED_fb_puts(int, int, char *);
+
+void OLED_fb_clear(void);
+
+int OLED_flush(void);
+
+#endif /* OLED_DISPLAY_H */
@@ -0,0 +1,168 @@
+/**********************************************************************/
+//	acquire.c   October 17, 2026
+/***********************************************************************
+	DMA driven SPI acquisition of both microphones and the MAX187.
+
+	Each tick the timer ISR calls acquire_flip(), which hands back the
+	sample the DMA engine captured during the previous tick and starts
+	the control block chain for the next one into the other half of a
+	ping-pong pair. The ISR never waits on SPI_CS.
+
+	Every SPI transaction is a run of seven control blocks, chip select
+	low through GPCLR0, DLEN, TA with DMAEN, the command word into the
+	FIFO, the reply out of the FIFO paced by the SPI RX DREQ, TA off
+	and chip select high through GPSET0. The chip selects stay plain
+	GPIO outputs as wired on the board. The MAX187 needs 8.5us to
+	convert after its select goes low, the convert block burns ~10us
+	copying a pad buffer onto itself with the maximum wait states.
+
+	The data cache sits between the CPU and the chains. Control blocks
+	are cleaned to SDRAM after the CPU writes them, and each chain's
+	reply words have a cache line to themselves so they can be
+	invalidated before they are read.
+***********************************************************************/
+#include "acquire.h"
+#include "dma.h"
+#include "peripheral.h"
+#include "hal.h"
+
+#define SPI_CS_DMAEN	(1 << 8)
+#define CONVERT_BYTES	256
+
+typedef struct {
+	DmaControlBlock select;
+	DmaControlBlock length;
+	DmaControlBlock start;
+	DmaControlBlock tx;
+	DmaControlBlock rx;
+	DmaControlBlock stop;
+	DmaControlBlock deselect;
+} SpiTransfer;
+
+typedef struct {
+	SpiTransfer mic_one;
+	SpiTransfer mic_two;
+	DmaControlBlock convert;
+	SpiTransfer cuff;
+	// reply words as clocked in, first byte lowest, three used out of
+	// a whole cache line
+	unsigned int rx[8] __attribute__((aligned(32)));
+} AcquireChain;
+
+static struct {
+	AcquireChain chain[2];
+	unsigned int ce0, ce1, ce2;	// chip select masks for GPSET0/GPCLR0
+	unsigned int dlen;
+	unsigned int mic_start, cuff_start, stop;
+	unsigned int mic_cmd, cuff_cmd;
+	unsigned int pad[CONVERT_BYTES / 4];
+} acq __attribute__((aligned(32)));
+
+static AcquireSample samples[2];
+static int with_cuff_pending[2];
+static int active = -1;
+static unsigned int overruns = 0;
+
+#define BUS(p) hal_bus_addr((p), sizeof(*(p)))
+
+//----------------------------------------------------------------------
+static void cb_set(DmaControlBlock* cb, unsigned int ti, unsigned int src,
+	unsigned int dst, unsigned int len, DmaControlBlock* next) {
+	cb->ti = ti | DMA_TI_NO_WIDE;
+	cb->source_ad = src;
+	cb->dest_ad = dst;
+	cb->txfr_len = len;
+	cb->stride = 0;
+	cb->nextconbk = next ? BUS(next) : 0;
+}
+
+// word writes to a peripheral register
+static void cb_poke(DmaControlBlock* cb, unsigned int reg, unsigned int* val,
+	DmaControlBlock* next) {
+	cb_set(cb, DMA_TI_WAIT_RESP, BUS(val), BUS_PERIPHERAL(reg), 4, next);
+}
+
+static void transfer_build(SpiTransfer* t, unsigned int* cs_mask,
+	unsigned int* start, unsigned int* cmd, unsigned int* rx,
+	DmaControlBlock* after_select, DmaControlBlock* next) {
+	cb_poke(&t->select, GPCLR0, cs_mask, after_select ? after_select : &t->length);
+	cb_poke(&t->length, SPI_DLEN, &acq.dlen, &t->start);
+	cb_poke(&t->start, SPI_CS, start, &t->tx);
+	cb_set(&t->tx, DMA_TI_WAIT_RESP | DMA_TI_DEST_DREQ |
+		DMA_TI_PERMAP(DMA_DREQ_SPI_TX),
+		BUS(cmd), BUS_PERIPHERAL(SPI_FIFO), 4, &t->rx);
+	cb_set(&t->rx, DMA_TI_SRC_DREQ | DMA_TI_PERMAP(DMA_DREQ_SPI_RX),
+		BUS_PERIPHERAL(SPI_FIFO), BUS(rx), 4, &t->stop);
+	cb_poke(&t->stop, SPI_CS, &acq.stop, &t->deselect);
+	cb_poke(&t->deselect, GPSET0, cs_mask, next);
+}
+
+//----------------------------------------------------------------------
+void acquire_init(void) {
+	hal_bus_addr(&acq, sizeof(acq));	//map the whole block first
+
+	acq.ce0 = 1 << 8;
+	acq.ce1 = 1 << 7;
+	acq.ce2 = 1 << 25;
+	acq.dlen = 2;
+	acq.mic_start = 0xB4 | SPI_CS_DMAEN;	//clear fifos, TA=1, CPHA
+	acq.cuff_start = 0xB0 | SPI_CS_DMAEN;
+	acq.stop = 0;
+	acq.mic_cmd = 0xEB81;					//0x81 then 0xEB
+	acq.cuff_cmd = 0;
+
+	for(int ix = 0; ix < 2; ++ix) {
+		AcquireChain* c = &acq.chain[ix];
+		transfer_build(&c->mic_one, &acq.ce1, &acq.mic_start, &acq.mic_cmd,
+			&c->rx[0], 0, &c->mic_two.select);
+		transfer_build(&c->mic_two, &acq.ce0, &acq.mic_start, &acq.mic_cmd,
+			&c->rx[1], 0, 0);
+		transfer_build(&c->cuff, &acq.ce2, &acq.cuff_start, &acq.cuff_cmd,
+			&c->rx[2], &c->convert, 0);
+		cb_set(&c->convert, DMA_TI_SRC_INC | DMA_TI_DEST_INC | DMA_TI_WAITS(31),
+			BUS(&acq.pad), BUS(&acq.pad), CONVERT_BYTES, &c->cuff.length);
+	}
+
+	hal_cache_clean(&acq, sizeof(acq));
+	dma_init(ACQUIRE_DMA_CHANNEL);
+	active = -1;
+}
+
+//----------------------------------------------------------------------
+// Returns the sample captured since the last call, or 0 on the first
+// call and when the previous chain has not finished (an overrun).
+//----------------------------------------------------------------------
+const AcquireSample* acquire_flip(int with_cuff) {
+	const AcquireSample* done = 0;
+
+	if(dma_busy(ACQUIRE_DMA_CHANNEL)) {
+		++overruns;
+		return 0;
+	}
+
+	if(active >= 0) {
+		const unsigned int* rx = acq.chain[active].rx;
+		hal_cache_invalidate(rx, sizeof(acq.chain[active].rx));
+		AcquireSample* s = &samples[active];
+		s->mic_one = (short)(((rx[0] & 0xFF) << 8) | ((rx[0] >> 8) & 0xFF));
+		s->mic_two = (short)(((rx[1] & 0xFF) << 8) | ((rx[1] >> 8) & 0xFF));
+		if(with_cuff_pending[active])
+			s->cuff = ((rx[2] & 0x7F) << 5) + (((rx[2] >> 8) & 0xFF) >> 3);
+		else
+			s->cuff = -1;
+		done = s;
+	}
+
+	active = (active + 1) & 1;
+	AcquireChain* c = &acq.chain[active];
+	c->mic_two.deselect.nextconbk = with_cuff ? BUS(&c->cuff.select) : 0;
+	hal_cache_clean(&c->mic_two.deselect, sizeof(DmaControlBlock));
+	with_cuff_pending[active] = with_cuff;
+	dma_start(ACQUIRE_DMA_CHANNEL, BUS(&c->mic_one.select));
+	return done;
+}
+
+//----------------------------------------------------------------------
+unsigned int acquire_overruns(void) {
+	return overruns;
+}
@@ -0,0 +1,19 @@
+/**********************************************************************/
+//	acquire.h   October 17, 2026
+/**********************************************************************/
+#ifndef ACQUIRE_H
+#define ACQUIRE_H
+
+#define ACQUIRE_DMA_CHANNEL	5
+
+typedef struct {
+	short mic_one;
+	short mic_two;
+	int cuff;		// raw 12 bit MAX187 reading, -1 if not converted
+} AcquireSample;
+
+void acquire_init(void);
+const AcquireSample* acquire_flip(int with_cuff);
+unsigned int acquire_overruns(void);
+
+#endif /* ACQUIRE_H */
@@ -0,0 +1,1181 @@
+/**********************************************************************/
+//	bench.c   October 17, 2026
+/***********************************************************************
+	Host benchmarks for the firmware core. Each benchmark times the
+	routine under test with CLOCK_MONOTONIC and prints ns per call.
+
+	Benchmarks that check a result against a reference print ok or FAIL
+	against a stated tolerance, and any FAIL makes the exit status 1.
+
+	usage: bpsure_bench [name ...]     runs every benchmark by default
+***********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "hal.h"
+#include "library.h"
+#include "math.h"
+#include "fixed.h"
+#include "stats.h"
+#include "ring.h"
+#include "fft.h"
+#include "nlms.h"
+#include "bp.h"
+#include "biquad.h"
+#include "pipeline.h"
+#include "sched.h"
+#include "OLED_display.h"
+#include "peripheral.h"
+#include "uart.h"
+
+static volatile float sink_f;
+static int failures = 0;
+
+static uint32_t seed = 1;
+
+static int matches(const char* a, const char* b) {
+	while(*a && *a == *b) { ++a; ++b; }
+	return *a == *b;
+}
+static int noise(int range) {
+	seed = seed * 1103515245 + 12345;
+	return (int)((seed >> 8) % (unsigned int)range);
+}
+
+//----------------------------------------------------------------------
+// RingBuffer: running sums against the two pass full scan, then the
+// generic Ring's spans against a per-element gather
+//----------------------------------------------------------------------
+#define RING_SIZE		1024
+#define RING_WINDOW		256
+#define RING_BLOCK		20
+
+static void bench_ring(void) {
+	static RingBuffer ring;
+	const int samples = 200000;
+	unsigned long long start, fast, full;
+	float worst = 0;
+
+	InitRingBuffer(&ring);
+	start = hal_host_nanos();
+	for(int ix = 0; ix < samples; ++ix) {
+		WriteToRingBuffer(&ring, noise(1 << 30));
+		sink_f = DetermineDeviation(&ring);
+	}
+	fast = hal_host_nanos() - start;
+
+	InitRingBuffer(&ring);
+	start = hal_host_nanos();
+	for(int ix = 0; ix < samples; ++ix) {
+		WriteToRingBuffer(&ring, noise(1 << 30));
+		sink_f = DetermineDeviationFull(&ring);
+	}
+	full = hal_host_nanos() - start;
+
+	// drift of the running sums against the scan, relative to the scan
+	InitRingBuffer(&ring);
+	for(int ix = 0; ix < samples; ++ix) {
+		WriteToRingBuffer(&ring, noise(1 << 30));
+		float ref = DetermineDeviationFull(&ring);
+		float err = (DetermineDeviation(&ring) - ref) / (ref ? ref : 1);
+		if(abs(err) > worst) worst = abs(err);
+	}
+
+	printf("ring     RINGBUFFER_SIZE %d\n", RINGBUFFER_SIZE);
+	printf("  write+deviation  running %.1f ns  full scan %.1f ns  (%.1fx)\n",
+		(double)fast / samples, (double)full / samples, (double)full / fast);
+	printf("  max relative error vs full scan %.2e\n", worst);
+
+	// generic int16 ring, window statistics over the spans against a
+	// gather of the same window an element at a time
+	static int16_t storage[RING_SIZE], block[RING_BLOCK], gathered[RING_WINDOW];
+	Ring r;
+	WindowStats a, b;
+	unsigned long long push, bulk, spans, gather;
+	int exact = 1;
+
+	ring_init(&r, storage, RING_SIZE, sizeof(int16_t));
+	start = hal_host_nanos();
+	for(int ix = 0; ix < samples; ++ix) RING_PUSH(&r, int16_t, (int16_t)ix);
+	push = hal_host_nanos() - start;
+
+	for(int ix = 0; ix < RING_BLOCK; ++ix) block[ix] = (int16_t)(noise(65536) - 32768);
+	start = hal_host_nanos();
+	for(int ix = 0; ix < samples / RING_BLOCK; ++ix) ring_write(&r, block, RING_BLOCK);
+	bulk = hal_host_nanos() - start;
+
+	int calls = samples / RING_BLOCK;
+	start = hal_host_nanos();
+	for(int ix = 0; ix < calls; ++ix) {
+		ring_write(&r, block, 1 + (ix & 7));		//moves the wrap about
+		stats_ring_s16(&r, RING_WINDOW, &a);
+		sink_f = a.sum;
+	}
+	spans = hal_host_nanos() - start;
+
+	start = hal_host_nanos();
+	for(int ix = 0; ix < calls; ++ix) {
+		ring_write(&r, block, 1 + (ix & 7));
+		for(int jx = 0; jx < RING_WINDOW; ++jx)
+			gathered[jx] = RING_AT(&r, int16_t, RING_SIZE - RING_WINDOW + jx);
+		stats_s16(gathered, RING_WINDOW, &b);
+		sink_f = b.sum;
+	}
+	gather = hal_host_nanos() - start;
+
+	for(int ix = 0; ix < RING_SIZE + RING_BLOCK; ++ix) {
+		ring_write(&r, block, 1 + (ix % RING_BLOCK));
+		stats_ring_s16(&r, RING_WINDOW, &a);
+		for(int jx = 0; jx < RING_WINDOW; ++jx)
+			gathered[jx] = RING_AT(&r, int16_t, RING_SIZE - RING_WINDOW + jx);
+		stats_s16_scalar(gathered, RING_WINDOW, &b);
+		if(a.sum != b.sum || a.squares != b.squares || a.count != b.count) exact = 0;
+	}
+	if(!exact) ++failures;
+
+	printf("  int16 Ring of %d, window %d\n", RING_SIZE, RING_WINDOW);
+	printf("  push %.1f ns/sample  ring_write of %d %.1f ns/sample\n",
+		(double)push / samples, RING_BLOCK, (double)bulk / (samples / RING_BLOCK * RING_BLOCK));
+	printf("  window stats  over spans %.1f ns  gathered %.1f ns  (%.1fx)  %s\n",
+		(double)spans / calls, (double)gather / calls, (double)gather / spans,
+		exact ? "exact" : "MISMATCH");
+}
+
+//----------------------------------------------------------------------
+// ZScoreDetector against a per-sample rescan of the lag window with
+// meanf/stddevf, which is what thresholding() used to do at each index
+//----------------------------------------------------------------------
+static int rescan_update(float window[], int lag, int* count, float y,
+	float threshold, float influence) {
+	int signal = 0;
+	float value = y;
+
+	if(*count >= lag) {
+		float avg = meanf(window, lag);
+		float std = stddevf(window, lag);
+		if(fabs(y - avg) > threshold * std) {
+			signal = (y > avg) ? 1 : -1;
+			value = influence * y + (1 - influence) * window[lag - 1];
+		}
+	} else {
+		++*count;
+	}
+	for(int ix = 1; ix < lag; ++ix) window[ix - 1] = window[ix];
+	window[lag - 1] = value;
+	return signal;
+}
+
+static void bench_zscore(void) {
+	static const int lags[] = { 8, 32, 64 };
+	const int samples = 200000;
+	static float input[200000];
+	static ZScoreDetector det;
+	float window[ZSCORE_MAX_LAG];
+
+	for(int ix = 0; ix < samples; ++ix)
+		input[ix] = noise(1000) + ((ix % 640) < 40 ? 4000 : 0);
+
+	printf("zscore   threshold 3.5  influence 0.5\n");
+	for(unsigned int jx = 0; jx < sizeof(lags) / sizeof(lags[0]); ++jx) {
+		int lag = lags[jx], count = 0, mismatches = 0, peaks = 0;
+		unsigned long long start, streaming, rescan;
+		volatile int sink = 0;
+
+		InitZScore(&det, lag, 3.5f, 0.5f);
+		start = hal_host_nanos();
+		for(int ix = 0; ix < samples; ++ix)
+			sink += ZScoreUpdate(&det, input[ix]);
+		streaming = hal_host_nanos() - start;
+
+		for(int ix = 0; ix < lag; ++ix) window[ix] = 0;
+		start = hal_host_nanos();
+		for(int ix = 0; ix < samples; ++ix)
+			sink += rescan_update(window, lag, &count, input[ix], 3.5f, 0.5f);
+		rescan = hal_host_nanos() - start;
+
+		InitZScore(&det, lag, 3.5f, 0.5f);
+		count = 0;
+		for(int ix = 0; ix < lag; ++ix) window[ix] = 0;
+		for(int ix = 0; ix < samples; ++ix) {
+			int a = ZScoreUpdate(&det, input[ix]);
+			int b = rescan_update(window, lag, &count, input[ix], 3.5f, 0.5f);
+			if(a != b) ++mismatches;
+			if(a > 0) ++peaks;
+		}
+
+		printf("  lag %2d  streaming %.1f ns/sample  rescan %.1f ns/sample"
+			"  (%.1fx)  %d peak samples, %d mismatches\n", lag,
+			(double)streaming / samples, (double)rescan / samples,
+			(double)rescan / streaming, peaks, mismatches);
+	}
+}
+
+//----------------------------------------------------------------------
+// OLED_flush cost against how much of the framebuffer changed
+//----------------------------------------------------------------------
+static unsigned long long flush_ns(int* sent) {
+	unsigned long long start = hal_host_nanos();
+	*sent = OLED_flush();
+	return hal_host_nanos() - start;
+}
+
+static void bench_oled(void) {
+	char digits[8];
+	int sent;
+	unsigned long long ns;
+
+	hal_host_reset();
+	OLED_init();
+	printf("oled     16x2 framebuffer flush\n");
+
+	OLED_fb_puts(1, 2, "bpSure Monitor");
+	OLED_fb_puts(2, 1, "Cuff Press = 120");
+	ns = flush_ns(&sent);
+	printf("  full screen     %2d cells  %8llu ns\n", sent, ns);
+
+	ns = flush_ns(&sent);
+	printf("  unchanged       %2d cells  %8llu ns\n", sent, ns);
+
+	itos(digits, 121, 3);
+	OLED_fb_puts(2, 13, digits);
+	ns = flush_ns(&sent);
+	printf("  one digit       %2d cells  %8llu ns\n", sent, ns);
+
+	itos(digits, 987, 3);
+	OLED_fb_puts(2, 13, digits);
+	ns = flush_ns(&sent);
+	printf("  three digits    %2d cells  %8llu ns\n", sent, ns);
+
+	ns = hal_host_nanos();
+	OLED_pos(1, 2);
+	OLED_puts("bpSure Monitor");
+	OLED_pos(2, 1);
+	OLED_puts("Cuff Press = 987");
+	ns = hal_host_nanos() - ns;
+	printf("  OLED_puts redraw 30 cells %8llu ns\n", ns);
+}
+
+//----------------------------------------------------------------------
+// sustained mini UART transmit through uart_write and uart_isr, against
+// the mock FIFO draining at the configured baud rate
+//----------------------------------------------------------------------
+static void bench_uart(void) {
+	static unsigned char block[64];
+	const unsigned int total = 16384;
+	unsigned int queued = 0, isr_calls = 0;
+	unsigned long long start, elapsed, isr_ns = 0;
+
+	hal_host_reset();
+	uart_init();
+	for(unsigned int ix = 0; ix < sizeof(block); ++ix) block[ix] = ix;
+
+	start = hal_host_nanos();
+	while(hal_host_uart_tx_count() < total) {
+		int room = uart_tx_room();
+		int len = total - queued < sizeof(block) ? total - queued : sizeof(block);
+		if(len > room) len = room;
+		if(len > 0) queued += uart_write(block, len);
+
+		if(GET32(IRQ_PEND1) & UART_IRQ) {
+			unsigned long long t = hal_host_nanos();
+			uart_isr();
+			isr_ns += hal_host_nanos() - t;
+			++isr_calls;
+		}
+	}
+	elapsed = hal_host_nanos() - start;
+
+	double baud = 250e6 / (8.0 * (GET32(AUX_MU_BAUD_REG) + 1));
+	double rate = total * 1e9 / elapsed;
+	printf("uart     AUX_MU_BAUD_REG %u, %.0f baud\n", GET32(AUX_MU_BAUD_REG), baud);
+	printf("  tx %u bytes  %.0f bytes/s  %.1f%% of line rate\n",
+		total, rate, rate * 1000 / baud);
+	printf("  uart_isr %u calls  %.1f ns/call  overflow rx %u tx %u\n",
+		isr_calls, (double)isr_ns / (isr_calls ? isr_calls : 1),
+		uart_stats.rx_overflow, uart_stats.tx_overflow);
+}
+
+//----------------------------------------------------------------------
+// Q15/Q31 signal path against the float one, sample by sample, then the
+// cost of a tick's product, window write, detector update and deviation
+// on each path in hal_cycles (ns on the host)
+//----------------------------------------------------------------------
+#define FIXED_SAMPLES			200000
+#define FIXED_DEV_TOLERANCE		1e-4	// relative to the float deviation
+#define FIXED_SIGNAL_TOLERANCE	1e-3	// fraction of detector decisions
+
+static int product_float(short a, short b) {
+	float val = (float)a * (float)b;
+	return (int)(val < 0 ? 0 : val);
+}
+
+static q31_t product_q31(short a, short b) {
+	q31_t val = q15_mul_q31(a, b);
+	return val < 0 ? 0 : val;
+}
+
+static void bench_fixed(void) {
+	static short mic_one[FIXED_SAMPLES], mic_two[FIXED_SAMPLES];
+	static RingBuffer ring;
+	static RingBufferQ31 ring_q31;
+	static ZScoreDetector det;
+	static ZScoreQ31 det_q31;
+	int product_err = 0, float_err = 0, mismatches = 0, peaks = 0;
+	float dev_err = 0;
+	volatile int sink = 0;
+
+	for(int ix = 0; ix < FIXED_SAMPLES; ++ix) {
+		int pulse = isin((int16_t)(ix * 98)) >> 2;
+		if((ix % 640) < 40) pulse *= 3;		// beats for the detector
+		mic_one[ix] = q15_sat(pulse + noise(1024) - 512);
+		mic_two[ix] = q15_sat(pulse + noise(1024) - 512);
+	}
+
+	InitRingBuffer(&ring);
+	InitRingBufferQ31(&ring_q31);
+	InitZScore(&det, 32, 3.5f, 0.5f);
+	InitZScoreQ31(&det_q31, 32, 3.5f, 0.5f);
+	for(int ix = 0; ix < FIXED_SAMPLES; ++ix) {
+		int exact = max(mic_one[ix] * mic_two[ix], 0);
+		int val = product_float(mic_one[ix], mic_two[ix]);
+		q31_t val_q31 = product_q31(mic_one[ix], mic_two[ix]);
+		if(abs(exact - (val_q31 >> 1)) > product_err) product_err = abs(exact - (val_q31 >> 1));
+		if(abs(exact - val) > float_err) float_err = abs(exact - val);
+
+		WriteToRingBuffer(&ring, val);
+		WriteToRingBufferQ31(&ring_q31, val_q31);
+		float ref = DetermineDeviation(&ring);
+		float rel = ((DetermineDeviationQ31(&ring_q31) >> 1) - ref) / (ref > 1 ? ref : 1);
+		if(abs(rel) > dev_err) dev_err = abs(rel);
+
+		int signal = ZScoreUpdate(&det, val);
+		if(signal != ZScoreUpdateQ31(&det_q31, val_q31)) ++mismatches;
+		if(signal > 0) ++peaks;
+	}
+
+	InitRingBuffer(&ring);
+	InitZScore(&det, 32, 3.5f, 0.5f);
+	unsigned int start = hal_cycles();
+	for(int ix = 0; ix < FIXED_SAMPLES; ++ix) {
+		int val = product_float(mic_one[ix], mic_two[ix]);
+		WriteToRingBuffer(&ring, val);
+		sink += ZScoreUpdate(&det, val);
+		sink += (int)DetermineDeviation(&ring);
+	}
+	unsigned int cycles_float = hal_cycles() - start;
+
+	InitRingBufferQ31(&ring_q31);
+	InitZScoreQ31(&det_q31, 32, 3.5f, 0.5f);
+	start = hal_cycles();
+	for(int ix = 0; ix < FIXED_SAMPLES; ++ix) {
+		q31_t val = product_q31(mic_one[ix], mic_two[ix]);
+		WriteToRingBufferQ31(&ring_q31, val);
+		sink += ZScoreUpdateQ31(&det_q31, val);
+		sink += DetermineDeviationQ31(&ring_q31);
+	}
+	unsigned int cycles_q31 = hal_cycles() - start;
+
+	int dev_ok = dev_err <= FIXED_DEV_TOLERANCE;
+	int signal_ok = mismatches <= FIXED_SIGNAL_TOLERANCE * FIXED_SAMPLES;
+	if(product_err > 1 || !dev_ok || !signal_ok) ++failures;
+
+	printf("fixed    Q15/Q31 against float, RINGBUFFER_SIZE %d, lag 32\n", RINGBUFFER_SIZE);
+	printf("  product    max error %d, float %d       %s (1)\n", product_err,
+		float_err, product_err <= 1 ? "ok" : "FAIL");
+	printf("  deviation  max relative error %.2e  %s (%.0e)\n", dev_err,
+		dev_ok ? "ok" : "FAIL", FIXED_DEV_TOLERANCE);
+	printf("  detector   %d of %d decisions differ, %d peak samples  %s (%.0e)\n",
+		mismatches, FIXED_SAMPLES, peaks, signal_ok ? "ok" : "FAIL",
+		FIXED_SIGNAL_TOLERANCE);
+	printf("  per tick   float %.1f  fixed %.1f hal_cycles  (%.2fx)\n",
+		(double)cycles_float / FIXED_SAMPLES, (double)cycles_q31 / FIXED_SAMPLES,
+		(double)cycles_float / cycles_q31);
+}
+
+//----------------------------------------------------------------------
+// math.c against long double libm. The local math.h shadows <math.h>,
+// so the references are declared here and bpsure_bench links -lm.
+// ULPs are of the result type and only counted where |reference| is
+// at least ULP_FLOOR, near a zero of sin or cos any error is many ULPs.
+//----------------------------------------------------------------------
+long double sqrtl(long double);
+long double logl(long double);
+long double expl(long double);
+long double sinl(long double);
+long double cosl(long double);
+long double powl(long double, long double);
+long double floorl(long double);
+long double fabsl(long double);
+long double frexpl(long double, int*);
+long double ldexpl(long double, int);
+
+#define MATH_POINTS		200000
+#define ULP_FLOOR		1e-3L
+#define MOD_DIVISOR		6.2831854	// as ang_360 uses it
+
+typedef struct {
+	const char* name;
+	const char* domain;
+	double (*fn)(double);
+	long double (*ref)(long double);
+	double lo, hi;
+	int geometric;			// log spaced points, for sqrt and ln
+	int mantissa;			// bits in the result type
+} MathCase;
+
+static double ln_d(double x) { return ln((float)x); }
+static double sincos_s(double x) { double s, c; sincos(x, &s, &c); return s; }
+static double sincos_c(double x) { double s, c; sincos(x, &s, &c); return c; }
+static double mod_d(double x) { return mod(x, MOD_DIVISOR); }
+static long double mod_ref(long double x) {
+	return x - MOD_DIVISOR * floorl(x / MOD_DIVISOR);
+}
+
+static const MathCase math_cases[] = {
+	{ "sqrt",     "1e-6 .. 1e6", sqrt,     sqrtl,    1e-6, 1e6, 1, 53 },
+	{ "ln",       "1e-6 .. 1e6", ln_d,     logl,     1e-6, 1e6, 1, 24 },
+	{ "sin",      "-2pi .. 2pi", sin,      sinl,    -6.2831853, 6.2831853, 0, 53 },
+	{ "sin",      "-1e3 .. 1e3", sin,      sinl,    -1e3, 1e3, 0, 53 },
+	{ "cos",      "-2pi .. 2pi", cos,      cosl,    -6.2831853, 6.2831853, 0, 53 },
+	{ "cos",      "-1e3 .. 1e3", cos,      cosl,    -1e3, 1e3, 0, 53 },
+	{ "sincos s", "-1e3 .. 1e3", sincos_s, sinl,    -1e3, 1e3, 0, 24 },
+	{ "sincos c", "-1e3 .. 1e3", sincos_c, cosl,    -1e3, 1e3, 0, 24 },
+	{ "mod 2pi",  "-1e3 .. 1e3", mod_d,    mod_ref, -1e3, 1e3, 0, 53 },
+};
+#define NUM_MATH_CASES (int)(sizeof(math_cases) / sizeof(math_cases[0]))
+
+static long double ulp(long double ref, int mantissa) {
+	int exponent;
+	frexpl(ref, &exponent);
+	return ldexpl(1.0L, exponent - mantissa);
+}
+
+static void bench_math(void) {
+	static double x[MATH_POINTS];
+	volatile double sink = 0;
+
+	printf("math     against long double libm, %d points per sweep\n", MATH_POINTS);
+	printf("  function  domain        max abs err   max ulp  hal_cycles/call\n");
+	for(int jx = 0; jx < NUM_MATH_CASES; ++jx) {
+		const MathCase* c = &math_cases[jx];
+		long double worst = 0, worst_ulp = 0;
+
+		for(int ix = 0; ix < MATH_POINTS; ++ix) {
+			long double t = (long double)ix / (MATH_POINTS - 1);
+			x[ix] = c->geometric ? c->lo * powl((long double)c->hi / c->lo, t)
+				: c->lo + (c->hi - c->lo) * t;
+		}
+
+		for(int ix = 0; ix < MATH_POINTS; ++ix) {
+			long double ref = c->ref(x[ix]);
+			long double err = fabsl(c->fn(x[ix]) - ref);
+			if(err > worst) worst = err;
+			if(fabsl(ref) >= ULP_FLOOR && err / ulp(ref, c->mantissa) > worst_ulp)
+				worst_ulp = err / ulp(ref, c->mantissa);
+		}
+
+		unsigned int start = hal_cycles();
+		for(int ix = 0; ix < MATH_POINTS; ++ix) sink += c->fn(x[ix]);
+		unsigned int cycles = hal_cycles() - start;
+
+		printf("  %-9s %-12s %11.3Le %9.3Lg %8.1f\n", c->name, c->domain,
+			worst, worst_ulp, (double)cycles / MATH_POINTS);
+	}
+
+	// isin/icos over every BAM angle, error in output LSBs
+	int isin_err = 0, icos_err = 0;
+	for(int ix = -32768; ix < 32768; ++ix) {
+		long double angle = ix * 3.14159265358979323846L / 32768;
+		int s = (int)floorl(32767 * sinl(angle) + 0.5L);
+		int c = (int)floorl(32767 * cosl(angle) + 0.5L);
+		if(abs(isin((int16_t)ix) - s) > isin_err) isin_err = abs(isin((int16_t)ix) - s);
+		if(abs(icos((int16_t)ix) - c) > icos_err) icos_err = abs(icos((int16_t)ix) - c);
+	}
+	unsigned int start = hal_cycles();
+	for(int ix = 0; ix < 4 * 65536; ++ix) sink += isin((int16_t)ix);
+	unsigned int cycles = hal_cycles() - start;
+	printf("  %-9s %-12s %8d lsb  %9s %8.1f\n", "isin", "all BAM", isin_err, "",
+		(double)cycles / (4 * 65536));
+	start = hal_cycles();
+	for(int ix = 0; ix < 4 * 65536; ++ix) sink += icos((int16_t)ix);
+	cycles = hal_cycles() - start;
+	printf("  %-9s %-12s %8d lsb  %9s %8.1f\n", "icos", "all BAM", icos_err, "",
+		(double)cycles / (4 * 65536));
+}
+
+//----------------------------------------------------------------------
+// int16 window sum and sum of squares, the build's stats_s16 kernel
+// against the scalar loop and the two pass meani/stddevi, over several
+// window sizes
+//----------------------------------------------------------------------
+#define STATS_SAMPLES	(1 << 22)		// per window size and method
+
+static void bench_stats(void) {
+	static const int windows[] = { 16, 32, 64, 256, 1024, 4096 };
+	static int16_t x[4096 + 1];
+	static int xi[4096];
+	volatile float sink = 0;
+
+	for(int ix = 0; ix < 4096 + 1; ++ix) x[ix] = (int16_t)(noise(65536) - 32768);
+	for(int ix = 0; ix < 4096; ++ix) xi[ix] = x[ix + 1];
+
+	printf("stats    int16 window sum and squares, %s kernel\n", stats_kernel());
+	printf("  window   kernel ns  scalar ns  two pass ns  (x scalar)  (x two pass)\n");
+	for(unsigned int jx = 0; jx < sizeof(windows) / sizeof(windows[0]); ++jx) {
+		int n = windows[jx], calls = STATS_SAMPLES / n, exact = 1;
+		WindowStats a, b;
+		float dev_err = 0;
+
+		// x + 1 is deliberately not word aligned
+		for(int offset = 0; offset < 2; ++offset) {
+			stats_s16(x + offset, n, &a);
+			stats_s16_scalar(x + offset, n, &b);
+			if(a.sum != b.sum || a.squares != b.squares) exact = 0;
+		}
+		float ref = stddevi(xi, n);
+		dev_err = abs(stats_deviation(&a) - ref) / ref;
+
+		unsigned long long start = hal_host_nanos();
+		for(int ix = 0; ix < calls; ++ix) {
+			stats_s16(x + (ix & 1), n, &a);
+			sink += a.sum;
+		}
+		unsigned long long kernel = hal_host_nanos() - start;
+
+		start = hal_host_nanos();
+		for(int ix = 0; ix < calls; ++ix) {
+			stats_s16_scalar(x + (ix & 1), n, &b);
+			sink += b.sum;
+		}
+		unsigned long long scalar = hal_host_nanos() - start;
+
+		start = hal_host_nanos();
+		for(int ix = 0; ix < calls; ++ix)
+			sink += meani(xi, n) + stddevi(xi, n);
+		unsigned long long two_pass = hal_host_nanos() - start;
+
+		if(!exact || dev_err > 1e-5) ++failures;
+		printf("  %6d %10.1f %10.1f %12.1f %10.1fx %12.1fx  %s, dev err %.1e\n", n,
+			(double)kernel / calls, (double)scalar / calls, (double)two_pass / calls,
+			(double)scalar / kernel, (double)two_pass / kernel,
+			exact ? "exact" : "MISMATCH", dev_err);
+	}
+}
+
+//----------------------------------------------------------------------
+// library.c memset/memcpy/memmove against byte loops. Every head and
+// tail alignment is checked first, then copies are timed with the
+// source and destination co-aligned and with the source one byte off.
+//----------------------------------------------------------------------
+#define MEM_BUFFER	65536 + 64
+#define MEM_BYTES	(1 << 24)		// per size and method
+
+// one byte per iteration as the target runs it, not vectorized
+__attribute__((optimize("no-tree-loop-distribute-patterns", "no-tree-vectorize")))
+static void byte_copy(unsigned char* d, const unsigned char* s, int n) {
+	for(int ix = 0; ix < n; ++ix) d[ix] = s[ix];
+}
+
+static int mem_check(void) {
+	static unsigned char src[256], dst[256], ref[256];
+	int bad = 0;
+
+	for(int ix = 0; ix < 256; ++ix) src[ix] = noise(256);
+	for(int n = 0; n < 100; ++n)
+		for(int so = 0; so < 4; ++so)
+			for(int dof = 0; dof < 4; ++dof) {
+				for(int ix = 0; ix < 256; ++ix) dst[ix] = ref[ix] = ix;
+				memcpy(dst + 64 + dof, src + so, n);
+				byte_copy(ref + 64 + dof, src + so, n);
+				for(int ix = 0; ix < 256; ++ix) bad += dst[ix] != ref[ix];
+
+				for(int ix = 0; ix < 256; ++ix) dst[ix] = ref[ix] = ix;
+				memset(dst + 64 + dof, so, n);
+				for(int ix = 0; ix < n; ++ix) ref[64 + dof + ix] = so;
+				for(int ix = 0; ix < 256; ++ix) bad += dst[ix] != ref[ix];
+
+				// overlapping, either direction
+				for(int shift = -9; shift <= 9; shift += 3) {
+					for(int ix = 0; ix < 256; ++ix) dst[ix] = ref[ix] = src[ix];
+					memmove(dst + 64 + dof + shift, dst + 64 + so, n);
+					unsigned char tmp[100];
+					byte_copy(tmp, ref + 64 + so, n);
+					byte_copy(ref + 64 + dof + shift, tmp, n);
+					for(int ix = 0; ix < 256; ++ix) bad += dst[ix] != ref[ix];
+				}
+			}
+	return bad;
+}
+
+static void bench_mem(void) {
+	static const int sizes[] = { 4, 16, 64, 256, 4096, 65536 };
+	static unsigned char a[MEM_BUFFER], b[MEM_BUFFER];
+	int bad = mem_check();
+
+	if(bad) ++failures;
+	printf("mem      library.c, all alignments and overlaps 0..99 bytes: %s\n",
+		bad ? "FAIL" : "ok");
+	printf("  bytes   memcpy GB/s  byte loop  unaligned src  memmove  memset\n");
+	for(unsigned int jx = 0; jx < sizeof(sizes) / sizeof(sizes[0]); ++jx) {
+		int n = sizes[jx], calls = MEM_BYTES / n;
+		unsigned long long t[5];
+
+		t[0] = hal_host_nanos();
+		for(int ix = 0; ix < calls; ++ix) memcpy(b + (ix & 4), a + (ix & 4), n);
+		t[0] = hal_host_nanos() - t[0];
+		t[1] = hal_host_nanos();
+		for(int ix = 0; ix < calls; ++ix) byte_copy(b + (ix & 4), a + (ix & 4), n);
+		t[1] = hal_host_nanos() - t[1];
+		t[2] = hal_host_nanos();
+		for(int ix = 0; ix < calls; ++ix) memcpy(b + (ix & 4), a + 1 + (ix & 4), n);
+		t[2] = hal_host_nanos() - t[2];
+		t[3] = hal_host_nanos();
+		for(int ix = 0; ix < calls; ++ix) memmove(a + 8, a + (ix & 4), n);
+		t[3] = hal_host_nanos() - t[3];
+		t[4] = hal_host_nanos();
+		for(int ix = 0; ix < calls; ++ix) memset(b + (ix & 4), ix, n);
+		t[4] = hal_host_nanos() - t[4];
+
+		printf("  %6d", n);
+		for(int kx = 0; kx < 5; ++kx)
+			printf(kx ? " %9.2f" : " %11.2f", (double)calls * n / t[kx]);
+		printf("\n");
+	}
+}
+
+//----------------------------------------------------------------------
+// bp_update on synthetic deflations, 800 Hz ticks with the cuff read
+// every 80th tick, decimated by 10 to 80 Hz as kernel.c runs it. The envelope is a Gaussian each side of MAP, shaped
+// to cross the default ratios exactly at the systolic and diastolic
+// pressures, gated by a 75 bpm beat and 20% noise.
+//----------------------------------------------------------------------
+#define BP_SYSTOLIC		120
+#define BP_DIASTOLIC	80
+#define BP_MEAN			93
+#define BP_TOLERANCE	3		// mmHg
+
+static int bp_amplitude(const BpConfig* cfg, int tick, float pressure) {
+	long double d = pressure - BP_MEAN, width;
+	if(d > 0)
+		width = (BP_SYSTOLIC - BP_MEAN) / sqrtl(-logl(cfg->systolic_ratio));
+	else
+		width = (BP_MEAN - BP_DIASTOLIC) / sqrtl(-logl(cfg->diastolic_ratio));
+	long double envelope = 20000 * expl(-(d / width) * (d / width));
+	long double beat = (tick % 640) < 160 ? 1.0L : 0.2L;
+	return (int)(envelope * beat * (0.9L + noise(2000) * 1e-4L));
+}
+
+static void bench_bp(void) {
+	static BpEngine bp;
+	static const float rates[] = { 2, 3, 4, 5 };	// mmHg/s deflation
+	Decimator envelope;
+	BpConfig cfg;
+	PulseInfo info;
+	unsigned long long total = 0, worst_tick = 0;
+	unsigned int ticks = 0;
+	int worst = 0, bad = 0;
+
+	bp_default_config(&cfg);
+	cfg.rate_hz = 80;
+	printf("bp       synthetic %d/%d MAP %d, ratios %.2f/%.2f\n",
+		BP_SYSTOLIC, BP_DIASTOLIC, BP_MEAN, cfg.systolic_ratio, cfg.diastolic_ratio);
+	for(unsigned int rx = 0; rx < sizeof(rates) / sizeof(rates[0]); ++rx) {
+		bp_init(&bp, &cfg);
+		decimator_init(&envelope, 10, DECIMATE_MAX);
+		int cuff = 0;
+		float pressure = 0;
+		BpState state = BP_IDLE;
+		for(int tick = 0; state != BP_DONE && state != BP_FAILED; ++tick) {
+			if(tick % 80 == 0) cuff = (int)pressure;
+			if(tick < 800 * 9) pressure += 20.0f / 800;		//up to 180
+			else pressure -= rates[rx] / 800;
+			int amplitude = bp_amplitude(&cfg, tick, cuff);
+
+			unsigned long long start = hal_host_nanos();
+			if(decimator_push(&envelope, amplitude))
+				state = bp_update(&bp, cuff, envelope.out);
+			unsigned long long elapsed = hal_host_nanos() - start;
+			total += elapsed;
+			if(elapsed > worst_tick) worst_tick = elapsed;
+			++ticks;
+		}
+
+		if(!bp_result(&bp, &info)) {
+			printf("  %.0f mmHg/s  no estimate: FAIL\n", rates[rx]);
+			++bad;
+			continue;
+		}
+		int err = max(abs(info.sistolic - BP_SYSTOLIC), abs(info.diastolic - BP_DIASTOLIC));
+		err = max(err, abs(info.mean - BP_MEAN));
+		if(err > worst) worst = err;
+		printf("  %.0f mmHg/s  %d/%d MAP %d\n", rates[rx],
+			info.sistolic, info.diastolic, info.mean);
+	}
+	if(bad || worst > BP_TOLERANCE) ++failures;
+	printf("  worst error %d mmHg, tolerance %d: %s\n", worst, BP_TOLERANCE,
+		bad || worst > BP_TOLERANCE ? "FAIL" : "ok");
+	printf("  decimator and bp_update %.1f ns/tick, worst tick %llu ns\n",
+		(double)total / ticks, worst_tick);
+}
+
+//----------------------------------------------------------------------
+// fixed point FFT: complex and real transforms of random full scale
+// int16 data against a long double DFT, as the signal to error ratio
+// over every bin, and the time per transform at each size
+//----------------------------------------------------------------------
+#define FFT_SNR_DB		70.0		// worst accepted, at any size
+#define FFT_SAMPLES		(1 << 20)	// per size and kind, for the timing
+
+static double fft_snr(const FftComplex* got, const long double* ref_re,
+	const long double* ref_im, int bins) {
+	long double signal = 0, error = 0;
+	for(int k = 0; k < bins; ++k) {
+		long double er = got[k].re - ref_re[k], ei = got[k].im - ref_im[k];
+		signal += ref_re[k] * ref_re[k] + ref_im[k] * ref_im[k];
+		error += er * er + ei * ei;
+	}
+	return error > 0 ? (double)(10 * logl(signal / error) / logl(10)) : 200;
+}
+
+static void dft(const long double* in_re, const long double* in_im, int n,
+	long double* out_re, long double* out_im, int bins) {
+	for(int k = 0; k < bins; ++k) {
+		long double sr = 0, si = 0;
+		for(int ix = 0; ix < n; ++ix) {
+			long double a = -2 * 3.14159265358979323846L * ((long long)k * ix % n) / n;
+			sr += in_re[ix] * cosl(a) - in_im[ix] * sinl(a);
+			si += in_re[ix] * sinl(a) + in_im[ix] * cosl(a);
+		}
+		out_re[k] = sr;
+		out_im[k] = si;
+	}
+}
+
+static void bench_fft(void) {
+	static FftComplex x[FFT_MAX], work[FFT_MAX];
+	static long double in_re[FFT_MAX], in_im[FFT_MAX], ref_re[FFT_MAX], ref_im[FFT_MAX];
+	static FftComplex packed[FFT_MAX / 2 + 1];
+	double worst = 1000;
+	volatile int32_t sink = 0;
+
+	fft_init();
+	printf("fft      radix-2 int32 data, Q15 twiddles, random int16 input\n");
+	printf("  points  complex ns  SNR dB   real ns  SNR dB\n");
+	for(int log2n = FFT_MIN_LOG2; log2n <= FFT_MAX_LOG2; ++log2n) {
+		int n = 1 << log2n, m = n / 2, calls = FFT_SAMPLES / n;
+
+		for(int ix = 0; ix < n; ++ix) {
+			x[ix].re = noise(65536) - 32768;
+			x[ix].im = noise(65536) - 32768;
+			in_re[ix] = x[ix].re;
+			in_im[ix] = x[ix].im;
+		}
+		for(int ix = 0; ix < n; ++ix) work[ix] = x[ix];
+		fft_complex(work, log2n);
+		dft(in_re, in_im, n, ref_re, ref_im, n);
+		double complex_snr = fft_snr(work, ref_re, ref_im, n);
+
+		// the real parts alone, packed two to a value
+		for(int ix = 0; ix < n; ++ix) in_im[ix] = 0;
+		for(int ix = 0; ix < m; ++ix) {
+			work[ix].re = x[2 * ix].re;
+			work[ix].im = x[2 * ix + 1].re;
+		}
+		fft_real(work, log2n);
+		dft(in_re, in_im, n, ref_re, ref_im, m + 1);
+		for(int k = 0; k < m; ++k) packed[k] = work[k];
+		packed[0].im = 0;
+		packed[m].re = work[0].im;
+		packed[m].im = 0;
+		double real_snr = fft_snr(packed, ref_re, ref_im, m + 1);
+
+		unsigned long long start = hal_host_nanos();
+		for(int ix = 0; ix < calls; ++ix) {
+			work[0] = x[ix & (n - 1)];
+			fft_complex(work, log2n);
+			sink += work[1].re;
+		}
+		unsigned long long complex_ns = hal_host_nanos() - start;
+
+		start = hal_host_nanos();
+		for(int ix = 0; ix < calls; ++ix) {
+			work[0] = x[ix & (n - 1)];
+			fft_real(work, log2n);
+			sink += work[1].re;
+		}
+		unsigned long long real_ns = hal_host_nanos() - start;
+
+		if(complex_snr < worst) worst = complex_snr;
+		if(real_snr < worst) worst = real_snr;
+		printf("  %6d %11.1f %7.1f %9.1f %7.1f\n", n,
+			(double)complex_ns / calls, complex_snr, (double)real_ns / calls, real_snr);
+	}
+	if(worst < FFT_SNR_DB) ++failures;
+	printf("  worst SNR %.1f dB, at least %.0f: %s\n", worst, FFT_SNR_DB,
+		worst < FFT_SNR_DB ? "FAIL" : "ok");
+}
+
+//----------------------------------------------------------------------
+// NLMS canceller: a tone burst signal plus noise that reaches the
+// primary microphone through an unknown 8 tap path, with the noise
+// alone, plus a little of its own, on the reference. Noise reduction
+// after convergence, float and Q15, for a few tap counts and steps,
+// then a quiet reference, which must neither stall nor wrap the Q15
+// weights
+//----------------------------------------------------------------------
+#define NLMS_SAMPLES	200000
+#define NLMS_SETTLE		40000		// not scored, the weights converge
+#define NLMS_MIN_DB		12.0		// worst accepted noise reduction
+
+typedef struct {
+	int taps;
+	float mu;
+} NlmsCase;
+
+static const NlmsCase nlms_cases[] = {
+	{ 8, 0.1f }, { 16, 0.1f }, { 32, 0.1f }, { 32, 0.02f }, { 32, 0.5f }, { 64, 0.1f },
+};
+
+static void bench_nlms(void) {
+	static const float path[8] = { 0.55f, -0.3f, 0.2f, 0.12f, -0.08f, 0.05f, -0.03f, 0.02f };
+	static short signal[NLMS_SAMPLES], primary[NLMS_SAMPLES], reference[NLMS_SAMPLES];
+	static Nlms f;
+	double worst = 1000;
+	volatile float sink = 0;
+
+	float v[8] = { 0 };
+	for(int ix = 0; ix < NLMS_SAMPLES; ++ix) {
+		for(int jx = 7; jx > 0; --jx) v[jx] = v[jx - 1];
+		v[0] = (float)(noise(12000) - 6000);
+		float heard = 0;
+		for(int jx = 0; jx < 8; ++jx) heard += path[jx] * v[jx];
+		int burst = (ix % 640) < 40;		// 80 Hz for 50 ms a beat
+		signal[ix] = burst ? (short)(4000 * sinl(2 * 3.14159265358979323846L * 80 * ix / 800)) : 0;
+		primary[ix] = (short)(signal[ix] + heard);
+		reference[ix] = (short)(v[0] + noise(200) - 100);
+	}
+
+	printf("nlms     reference mic cancelling an 8 tap noise path, %d samples\n", NLMS_SAMPLES);
+	printf("  taps    mu   float dB  ns/sample    q15 dB  ns/sample\n");
+	for(unsigned int cx = 0; cx < sizeof(nlms_cases) / sizeof(nlms_cases[0]); ++cx) {
+		const NlmsCase* c = &nlms_cases[cx];
+		double before = 0, after_float = 0, after_q15 = 0;
+
+		nlms_init(&f, c->taps, c->mu, 1000);
+		unsigned long long start = hal_host_nanos();
+		for(int ix = 0; ix < NLMS_SAMPLES; ++ix) {
+			float e = nlms_run(&f, reference[ix], primary[ix]);
+			sink += e;
+			if(ix < NLMS_SETTLE) continue;
+			double left = e - signal[ix], noisy = primary[ix] - signal[ix];
+			before += noisy * noisy;
+			after_float += left * left;
+		}
+		unsigned long long float_ns = hal_host_nanos() - start;
+
+		nlms_init(&f, c->taps, c->mu, 1000);
+		start = hal_host_nanos();
+		for(int ix = 0; ix < NLMS_SAMPLES; ++ix) {
+			q15_t e = nlms_run_q15(&f, reference[ix], primary[ix]);
+			sink += e;
+			if(ix < NLMS_SETTLE) continue;
+			double left = e - signal[ix];
+			after_q15 += left * left;
+		}
+		unsigned long long q15_ns = hal_host_nanos() - start;
+
+		double float_db = (double)(10 * logl(before / after_float) / logl(10));
+		double q15_db = (double)(10 * logl(before / after_q15) / logl(10));
+		if(float_db < worst) worst = float_db;
+		if(q15_db < worst) worst = q15_db;
+		printf("  %4d %5.2f %10.1f %10.1f %9.1f %10.1f\n", c->taps, c->mu,
+			float_db, (double)float_ns / NLMS_SAMPLES, q15_db, (double)q15_ns / NLMS_SAMPLES);
+	}
+
+	// noise alone from a reference at +-20 heard through 6x the path,
+	// weights up to 3.3, so the Q15 step is shifted left, not right
+	for(int ix = 0; ix < NLMS_SAMPLES; ++ix) {
+		for(int jx = 7; jx > 0; --jx) v[jx] = v[jx - 1];
+		v[0] = (float)(noise(40) - 20);
+		float heard = 0;
+		for(int jx = 0; jx < 8; ++jx) heard += 6 * path[jx] * v[jx];
+		signal[ix] = 0;
+		primary[ix] = (short)heard;
+		reference[ix] = (short)v[0];
+	}
+	double before = 0, after_float = 0, after_q15 = 0;
+	nlms_init(&f, 32, 0.05f, 1000);
+	for(int ix = 0; ix < NLMS_SAMPLES; ++ix) {
+		float e = nlms_run(&f, reference[ix], primary[ix]);
+		if(ix < NLMS_SETTLE) continue;
+		double left = e - signal[ix], noisy = primary[ix] - signal[ix];
+		before += noisy * noisy;
+		after_float += left * left;
+	}
+	nlms_init(&f, 32, 0.05f, 1000);
+	for(int ix = 0; ix < NLMS_SAMPLES; ++ix) {
+		q15_t e = nlms_run_q15(&f, reference[ix], primary[ix]);
+		if(ix < NLMS_SETTLE) continue;
+		double left = e - signal[ix];
+		after_q15 += left * left;
+	}
+	double float_db = (double)(10 * logl(before / after_float) / logl(10));
+	double q15_db = (double)(10 * logl(before / after_q15) / logl(10));
+	if(float_db < worst) worst = float_db;
+	if(q15_db < worst) worst = q15_db;
+	printf("  quiet reference, 32 taps mu 0.05: float %.1f dB, q15 %.1f dB\n", float_db, q15_db);
+
+	// the same reference against an unrelated +-20000 primary drives the
+	// float weights far past what Q28 holds. The Q15 ones must pin at
+	// +-8, a step of more than 8 in one update is a wrap
+	unsigned int wraps = 0;
+	nlms_init(&f, 32, 0.05f, 1000);
+	for(int ix = 0; ix < NLMS_SETTLE; ++ix) {
+		int32_t was[NLMS_MAX_TAPS];
+		memcpy(was, f.w_q28, sizeof(was));
+		nlms_run_q15(&f, reference[ix], (short)(noise(40000) - 20000));
+		for(int jx = 0; jx < f.taps; ++jx)
+			if(llabs((long long)f.w_q28[jx] - was[jx]) > 1LL << 31) ++wraps;
+	}
+	if(wraps) ++failures;
+	printf("  quiet reference, loud primary: %u weight wraps in %d updates: %s\n",
+		wraps, NLMS_SETTLE, wraps ? "FAIL" : "ok");
+
+	if(worst < NLMS_MIN_DB) ++failures;
+	printf("  worst noise reduction %.1f dB, at least %.0f: %s\n", worst, NLMS_MIN_DB,
+		worst < NLMS_MIN_DB ? "FAIL" : "ok");
+}
+
+//----------------------------------------------------------------------
+// biquad cascades: the Korotkoff preset's response at a few tones, the
+// Q15 direct form I against the float transposed form on the same
+// input, and the cost per sample and per section of each
+//----------------------------------------------------------------------
+#define BIQUAD_FS		800.0f
+#define BIQUAD_SETTLE	4000
+#define BIQUAD_SAMPLES	200000
+#define BIQUAD_Q15_LSB	8		// Q15 against float, worst sample
+
+typedef struct {
+	float hz;
+	float lo_db, hi_db;		// accepted gain
+} BiquadTone;
+
+static const BiquadTone biquad_tones[] = {
+	{   5, -200, -40 },		// DC side, 4th order high-pass
+	{  60, -200, -30 },		// the notch
+	{ 100,   -1,   1 },		// pass band
+	{ 150,   -1,   1 },
+};
+
+static float biquad_gain_db(const BiquadCascade* f, float hz) {
+	BiquadState s;
+	long double in = 0, out = 0;
+
+	biquad_reset(&s);
+	for(int ix = 0; ix < BIQUAD_SETTLE * 3; ++ix) {
+		float x = (float)(10000 * sinl(2 * 3.14159265358979323846L * hz * ix / BIQUAD_FS));
+		float y = biquad_run(f, &s, x);
+		if(ix < BIQUAD_SETTLE) continue;
+		in += (long double)x * x;
+		out += (long double)y * y;
+	}
+	return (float)(10 * logl(out / in) / logl(10));
+}
+
+static void bench_biquad(void) {
+	static short input[BIQUAD_SAMPLES];
+	BiquadCascade f;
+	BiquadState s;
+	int bad = 0, worst = 0;
+	unsigned long long start, float_ns, q15_ns;
+
+	biquad_preset(&f, BIQUAD_KOROTKOFF_60HZ, BIQUAD_FS);
+	printf("biquad   Korotkoff preset with 60 Hz notch, %d sections at %.0f Hz\n",
+		f.sections, BIQUAD_FS);
+	for(unsigned int ix = 0; ix < sizeof(biquad_tones) / sizeof(biquad_tones[0]); ++ix) {
+		const BiquadTone* t = &biquad_tones[ix];
+		float db = biquad_gain_db(&f, t->hz);
+		int ok = db >= t->lo_db && db <= t->hi_db;
+		if(!ok) ++bad;
+		printf("  %5.0f Hz  %7.1f dB  %s\n", t->hz, db, ok ? "ok" : "FAIL");
+	}
+
+	// offset, hum, a pulse band tone and noise, as the microphones see it
+	for(int ix = 0; ix < BIQUAD_SAMPLES; ++ix) {
+		long double t = ix / (long double)BIQUAD_FS;
+		input[ix] = (short)(2000 + 6000 * sinl(2 * 3.14159265358979323846L * 60 * t)
+			+ 8000 * sinl(2 * 3.14159265358979323846L * 90 * t) + noise(8000) - 4000);
+	}
+	BiquadState q;
+	biquad_reset(&s);
+	biquad_reset(&q);
+	for(int ix = 0; ix < BIQUAD_SAMPLES; ++ix) {
+		float y = biquad_run(&f, &s, input[ix]);
+		int yq = biquad_run_q15(&f, &q, input[ix]);	//abs() is a macro
+		int err = abs(yq - (int)(y < 0 ? y - 0.5f : y + 0.5f));
+		if(err > worst) worst = err;
+	}
+	if(worst > BIQUAD_Q15_LSB) ++bad;
+	printf("  Q15 direct form I vs float, worst %d LSB, tolerance %d: %s\n",
+		worst, BIQUAD_Q15_LSB, worst > BIQUAD_Q15_LSB ? "FAIL" : "ok");
+	if(bad) ++failures;
+
+	biquad_reset(&s);
+	start = hal_host_nanos();
+	for(int ix = 0; ix < BIQUAD_SAMPLES; ++ix) sink_f = biquad_run(&f, &s, input[ix]);
+	float_ns = hal_host_nanos() - start;
+	biquad_reset(&q);
+	start = hal_host_nanos();
+	for(int ix = 0; ix < BIQUAD_SAMPLES; ++ix) sink_f = biquad_run_q15(&f, &q, input[ix]);
+	q15_ns = hal_host_nanos() - start;
+
+	double per_float = (double)float_ns / BIQUAD_SAMPLES / f.sections;
+	double per_q15 = (double)q15_ns / BIQUAD_SAMPLES / f.sections;
+	printf("  float transposed  %.1f ns/sample  %.2f ns/section\n",
+		(double)float_ns / BIQUAD_SAMPLES, per_float);
+	printf("  Q15 direct form I %.1f ns/sample  %.2f ns/section\n",
+		(double)q15_ns / BIQUAD_SAMPLES, per_q15);
+	printf("  sections per channel in 10%% of the 1250 us tick, 2 channels: "
+		"%.0f float  %.0f Q15\n", 125000 / per_float / 2, 125000 / per_q15 / 2);
+}
+
+//----------------------------------------------------------------------
+// pipeline phases for kernel.c's stage dividers, against every stage
+// on phase 0, and the decimators against a direct mean and max
+//----------------------------------------------------------------------
+static void bench_pipeline(void) {
+	static const unsigned int dividers[] = { 32, 80 };
+	const unsigned int hyperperiod = 160;
+	Pipeline p;
+	int bad = 0;
+
+	pipeline_init(&p);
+	for(unsigned int ix = 0; ix < sizeof(dividers) / sizeof(dividers[0]); ++ix)
+		pipeline_add(&p, "stage", dividers[ix], 0, 0);
+	int spread = pipeline_busiest(&p, hyperperiod);
+	for(int ix = 0; ix < p.stages; ++ix) {
+		p.stage[ix].phase = 0;
+		p.stage[ix].countdown = 1;
+	}
+	int stacked = pipeline_busiest(&p, hyperperiod);
+	if(spread > 1) ++bad;
+	printf("pipeline dividers 32 80, busiest tick of %u\n", hyperperiod);
+	printf("  phased %d stages  all on phase 0 %d stages: %s\n", spread, stacked,
+		spread > 1 ? "FAIL" : "ok");
+
+	Decimator mean, peak;
+	int errors = 0;
+	decimator_init(&mean, 10, DECIMATE_MEAN);
+	decimator_init(&peak, 10, DECIMATE_MAX);
+	for(int block = 0; block < 1000; ++block) {
+		int x[10], sum = 0, top = -1 << 30, ready = 0;
+		for(int ix = 0; ix < 10; ++ix) {
+			x[ix] = noise(200000) - 100000;
+			sum += x[ix];
+			if(x[ix] > top) top = x[ix];
+			ready = decimator_push(&mean, x[ix]);
+			decimator_push(&peak, x[ix]);
+		}
+		if(!ready || abs(mean.out - sum / 10) > 1 || peak.out != top) ++errors;
+	}
+	if(errors) ++bad;
+	printf("  decimate by 10, mean and max of 1000 blocks: %s\n", errors ? "FAIL" : "ok");
+	if(bad) ++failures;
+}
+
+//----------------------------------------------------------------------
+// scheduler dispatch order by priority then deadline, coalesced posts
+// and late starts on the virtual clock, and the post and run overhead
+//----------------------------------------------------------------------
+#define SCHED_RUNS	1000000
+
+static char sched_order[8];
+static int sched_ran = 0;
+
+static void sched_a(void) { sched_order[sched_ran++ & 7] = 'a'; }
+static void sched_b(void) { sched_order[sched_ran++ & 7] = 'b'; }
+static void sched_c(void) { sched_order[sched_ran++ & 7] = 'c'; }
+static void sched_d(void) { sched_order[sched_ran++ & 7] = 'd'; }
+
+static void bench_sched(void) {
+	Scheduler s;
+	TaskStats st;
+	int bad = 0;
+
+	hal_host_reset();
+	hal_host_clock_advance(0);			//CLO on the virtual clock
+	sched_init(&s);
+	int a = sched_add(&s, "a", sched_a, 1, 1000);
+	int b = sched_add(&s, "b", sched_b, 1, 100);
+	int c = sched_add(&s, "c", sched_c, 2, 5000);
+	int d = sched_add(&s, "d", sched_d, 0, 10);
+
+	sched_post(&s, a);
+	sched_post(&s, d);
+	sched_post(&s, b);
+	sched_post(&s, c);
+	sched_post(&s, a);
+	hal_host_clock_advance(50);
+	while(sched_run(&s) >= 0) continue;
+	sched_order[sched_ran] = '\0';
+	sched_read(&s, a, &st);
+	int order_ok = matches(sched_order, "cbad") && st.posts == 2 && st.runs == 1;
+	if(!order_ok) ++bad;
+	printf("sched dispatch of 4 tasks, 5 posts: %s %s\n", sched_order,
+		order_ok ? "ok" : "FAIL");
+
+	sched_read(&s, d, &st);
+	int missed_ok = st.missed == 1 && st.latency_max == 50;
+	if(!missed_ok) ++bad;
+	printf("  d 40 us past its deadline, missed %u latency %u us: %s\n",
+		st.missed, st.latency_max, missed_ok ? "ok" : "FAIL");
+
+	sched_reset(&s);
+	unsigned long long start = hal_host_nanos();
+	for(int ix = 0; ix < SCHED_RUNS; ++ix) {
+		sched_post(&s, c);
+		sched_run(&s);
+	}
+	unsigned long long ns = hal_host_nanos() - start;
+	sched_read(&s, c, &st);
+	if(st.runs != SCHED_RUNS) ++bad;
+	printf("  post and dispatch %.1f ns, %u of %u run: %s\n",
+		(double)ns / SCHED_RUNS, st.runs, SCHED_RUNS,
+		st.runs != SCHED_RUNS ? "FAIL" : "ok");
+	if(bad) ++failures;
+}
+
+//----------------------------------------------------------------------
+typedef struct {
+	const char* name;
+	void (*run)(void);
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+	{ "ring", bench_ring },
+	{ "zscore", bench_zscore },
+	{ "oled", bench_oled },
+	{ "uart", bench_uart },
+	{ "fixed", bench_fixed },
+	{ "math", bench_math },
+	{ "stats", bench_stats },
+	{ "mem", bench_mem },
+	{ "bp", bench_bp },
+	{ "fft", bench_fft },
+	{ "nlms", bench_nlms },
+	{ "biquad", bench_biquad },
+	{ "pipeline", bench_pipeline },
+	{ "sched", bench_sched },
+};
+#define NUM_BENCHMARKS (int)(sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+int main(int argc, char** argv) {
+	for(int ix = 0; ix < NUM_BENCHMARKS; ++ix) {
+		int run = argc < 2;
+		for(int jx = 1; jx < argc; ++jx)
+			if(matches(argv[jx], benchmarks[ix].name)) run = 1;
+		if(run) benchmarks[ix].run();
+	}
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,131 @@
+/**********************************************************************/
+//	biquad.c   October 17, 2026
+/***********************************************************************
+	Biquad cascades, see biquad.h. Q30 leaves two integer bits, which
+	covers |a1| < 2 for any stable section. In the direct form I each
+	product is Q15 x Q30, and five of them sum in an int64_t with room
+	to spare.
+
+	The 20 Hz high-pass poles sit close to z = 1, where they amplify
+	the noise from rounding the output back to Q15. The direct form I
+	feeds each section's truncation error into its next sample, which
+	moves that noise away from DC.
+***********************************************************************/
+#include "biquad.h"
+#include "library.h"
+#include "math.h"
+
+#define TWO_PI	6.28318530717958648
+
+//----------------------------------------------------------------------
+//	RBJ cookbook sections
+//----------------------------------------------------------------------
+void biquad_design(BiquadCoeffs* c, BiquadType type, float fs, float f0, float q) {
+	double w0 = TWO_PI * f0 / fs;
+	double cw = cos(w0), alpha = sin(w0) / (2 * q);
+	double b0, b1, b2, a0 = 1 + alpha;
+
+	switch(type) {
+		case BIQUAD_LOWPASS:
+			b0 = b2 = (1 - cw) / 2;
+			b1 = 1 - cw;
+			break;
+		case BIQUAD_HIGHPASS:
+			b0 = b2 = (1 + cw) / 2;
+			b1 = -(1 + cw);
+			break;
+		case BIQUAD_BANDPASS:
+			b0 = alpha;
+			b1 = 0;
+			b2 = -alpha;
+			break;
+		default:
+			b0 = b2 = 1;
+			b1 = -2 * cw;
+			break;
+	}
+	c->b0 = (float)(b0 / a0);
+	c->b1 = (float)(b1 / a0);
+	c->b2 = (float)(b2 / a0);
+	c->a1 = (float)(-2 * cw / a0);
+	c->a2 = (float)((1 - alpha) / a0);
+}
+
+void biquad_init(BiquadCascade* f) {
+	memset(f, 0, sizeof(*f));
+}
+
+static int32_t to_q30(float v) {
+	float scaled = v * (float)(1 << 30);
+	return (int32_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+}
+
+// appends a section, returns its index or -1 when the cascade is full
+int biquad_add(BiquadCascade* f, const BiquadCoeffs* c) {
+	if(f->sections == BIQUAD_MAX_SECTIONS) return -1;
+	int n = f->sections++;
+	f->coeffs[n] = *c;
+	f->q30[n][0] = to_q30(c->b0);
+	f->q30[n][1] = to_q30(c->b1);
+	f->q30[n][2] = to_q30(c->b2);
+	f->q30[n][3] = to_q30(c->a1);
+	f->q30[n][4] = to_q30(c->a2);
+	return n;
+}
+
+void biquad_preset(BiquadCascade* f, BiquadPreset preset, float fs) {
+	BiquadCoeffs c;
+
+	biquad_init(f);
+	biquad_design(&c, BIQUAD_HIGHPASS, fs, 20, 0.5412f);	//Butterworth pair
+	biquad_add(f, &c);
+	biquad_design(&c, BIQUAD_HIGHPASS, fs, 20, 1.3066f);
+	biquad_add(f, &c);
+	biquad_design(&c, BIQUAD_LOWPASS, fs, 200, 0.7071f);
+	biquad_add(f, &c);
+
+	if(preset == BIQUAD_KOROTKOFF_50HZ || preset == BIQUAD_KOROTKOFF_60HZ) {
+		biquad_design(&c, BIQUAD_NOTCH, fs,
+			preset == BIQUAD_KOROTKOFF_50HZ ? 50 : 60, 10);
+		biquad_add(f, &c);
+	}
+}
+
+void biquad_reset(BiquadState* s) {
+	memset(s, 0, sizeof(*s));
+}
+
+//----------------------------------------------------------------------
+//	one sample through every section
+//----------------------------------------------------------------------
+float biquad_run(const BiquadCascade* f, BiquadState* s, float x) {
+	for(int ix = 0; ix < f->sections; ++ix) {
+		const BiquadCoeffs* c = &f->coeffs[ix];
+		float* z = s->z[ix];
+		float y = c->b0 * x + z[0];
+		z[0] = c->b1 * x - c->a1 * y + z[1];
+		z[1] = c->b2 * x - c->a2 * y;
+		x = y;
+	}
+	return x;
+}
+
+q15_t biquad_run_q15(const BiquadCascade* f, BiquadState* s, q15_t x) {
+	for(int ix = 0; ix < f->sections; ++ix) {
+		const int32_t* q = f->q30[ix];
+		q15_t* xh = s->x[ix];
+		q15_t* yh = s->y[ix];
+		int64_t acc = (int64_t)q[0] * x + (int64_t)q[1] * xh[0]
+			+ (int64_t)q[2] * xh[1] - (int64_t)q[3] * yh[0]
+			- (int64_t)q[4] * yh[1] + s->error[ix];
+		int32_t whole = (int32_t)(acc >> 30);
+		q15_t y = q15_sat(whole);
+		s->error[ix] = y == whole ? (int32_t)(acc - ((int64_t)whole << 30)) : 0;
+		xh[1] = xh[0];
+		xh[0] = x;
+		yh[1] = yh[0];
+		yh[0] = y;
+		x = y;
+	}
+	return x;
+}
@@ -0,0 +1,64 @@
+/**********************************************************************/
+//	biquad.h   October 17, 2026
+/***********************************************************************
+	Cascaded biquad IIR filters for the microphone channels. A
+	BiquadCascade holds the sections' coefficients and may be shared by
+	any number of channels. Each channel keeps its own BiquadState.
+
+	Sections are designed in float from the RBJ cookbook formulas. They
+	are run either in transposed direct form II on the VFP, or in
+	direct form I on Q15 samples with Q30 coefficients and a 64 bit
+	accumulator. The Q15 form quantises only once per section, on its
+	output, with error feedback, and saturates it.
+
+	The presets cover the Korotkoff sound band, with or without a notch
+	for mains hum.
+***********************************************************************/
+#ifndef BIQUAD_H
+#define BIQUAD_H
+
+#include "fixed.h"
+
+#define BIQUAD_MAX_SECTIONS	6
+
+typedef enum {
+	BIQUAD_LOWPASS,
+	BIQUAD_HIGHPASS,
+	BIQUAD_BANDPASS,		// 0 dB at f0
+	BIQUAD_NOTCH
+} BiquadType;
+
+typedef enum {
+	BIQUAD_KOROTKOFF,		// 4th order high-pass at 20 Hz, 2nd order low-pass at 200 Hz
+	BIQUAD_KOROTKOFF_50HZ,	// the same with a 50 Hz notch
+	BIQUAD_KOROTKOFF_60HZ	// or a 60 Hz one
+} BiquadPreset;
+
+// a0 normalised to 1
+typedef struct {
+	float b0, b1, b2;
+	float a1, a2;
+} BiquadCoeffs;
+
+typedef struct {
+	int sections;
+	BiquadCoeffs coeffs[BIQUAD_MAX_SECTIONS];
+	int32_t q30[BIQUAD_MAX_SECTIONS][5];	// b0 b1 b2 a1 a2 as Q30
+} BiquadCascade;
+
+typedef struct {
+	float z[BIQUAD_MAX_SECTIONS][2];		// transposed form
+	q15_t x[BIQUAD_MAX_SECTIONS][2];		// direct form I history
+	q15_t y[BIQUAD_MAX_SECTIONS][2];
+	int32_t error[BIQUAD_MAX_SECTIONS];		// Q30 remainder of the last output
+} BiquadState;
+
+void biquad_design(BiquadCoeffs* c, BiquadType type, float fs, float f0, float q);
+void biquad_init(BiquadCascade* f);
+int  biquad_add(BiquadCascade* f, const BiquadCoeffs* c);
+void biquad_preset(BiquadCascade* f, BiquadPreset preset, float fs);
+void biquad_reset(BiquadState* s);
+float biquad_run(const BiquadCascade* f, BiquadState* s, float x);
+q15_t biquad_run_q15(const BiquadCascade* f, BiquadState* s, q15_t x);
+
+#endif /* BIQUAD_H */
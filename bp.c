@@ -0,0 +1,179 @@
+/**********************************************************************/
+//	bp.c   October 17, 2026
+/***********************************************************************
+	Oscillometric blood pressure from the amplitude envelope against
+	cuff pressure while the cuff deflates, see bp.h.
+
+	The envelope is the mean of the held peaks in each 2 mmHg bin.
+	Averaging the raw amplitude instead would depend on how each bin
+	happened to line up with the beats. Bins that
+	deflation stepped over are filled linearly from their neighbours,
+	then a 1-2-1 filter takes off the beat to beat ripple. The peak is
+	refined with a parabola through the three bins around it. Systolic
+	and diastolic are interpolated between the two bins either side of
+	where the envelope crosses its ratio of the peak.
+***********************************************************************/
+#include "bp.h"
+
+#define BIN_CENTER(i)	((i) * BP_BIN_MMHG + (BP_BIN_MMHG - 1) * 0.5f)
+
+//----------------------------------------------------------------------
+void bp_default_config(BpConfig* config) {
+	config->rate_hz = 800;
+	config->start_mmHg = 60;
+	config->stop_mmHg = 40;
+	config->deflate_mmHg = 5;
+	config->systolic_ratio = 0.55f;
+	config->diastolic_ratio = 0.75f;
+}
+
+void bp_init(BpEngine* bp, const BpConfig* config) {
+	memset(bp, 0, sizeof(*bp));
+	bp->config = *config;
+	bp->block_ticks = (int)(config->rate_hz * 0.125f + 0.5f);
+	if(bp->block_ticks < 1) bp->block_ticks = 1;
+	bp->state = BP_IDLE;
+	InitPulseInfo(&bp->result);
+}
+
+static void start_deflation(BpEngine* bp, int pressure) {
+	memset(bp->sum, 0, sizeof(bp->sum));
+	memset(bp->count, 0, sizeof(bp->count));
+	bp->bottom = pressure;
+	bp->lo = BP_BINS;
+	bp->hi = -1;
+	bp->block = 0;
+	bp->blocks = 0;
+	bp->ticks = 0;
+	bp->peak = 0;
+	bp->state = BP_DEFLATING;
+}
+
+// a block ended, bin the peak over the hold window at its mid pressure
+static void end_block(BpEngine* bp, int pressure) {
+	bp->block_max[bp->block] = bp->peak;
+	bp->block_pressure[bp->block] = pressure;
+	bp->block = (bp->block + 1) % BP_BLOCKS;
+	bp->peak = 0;
+	bp->ticks = 0;
+	if(bp->blocks < BP_BLOCKS) {
+		bp->blocks++;
+		return;
+	}
+
+	int peak = 0;
+	for(int ix = 0; ix < BP_BLOCKS; ++ix)
+		if(bp->block_max[ix] > peak) peak = bp->block_max[ix];
+	int mid = bp->block_pressure[(bp->block + BP_BLOCKS / 2 - 1) % BP_BLOCKS];
+
+	int bin = mid / BP_BIN_MMHG;
+	if(bin >= BP_BINS) bin = BP_BINS - 1;
+	bp->sum[bin] += peak;
+	bp->count[bin]++;
+	if(bin < bp->lo) bp->lo = bin;
+	if(bin > bp->hi) bp->hi = bin;
+}
+
+//----------------------------------------------------------------------
+//	the envelope from the bins, then MAP, systolic and diastolic
+//----------------------------------------------------------------------
+static BpState finish(BpEngine* bp) {
+	float* env = bp->envelope;
+	int lo = bp->lo, hi = bp->hi, last = -1;
+
+	if(hi - lo < 4) return BP_FAILED;			//too little deflation seen
+
+	for(int ix = lo; ix <= hi; ++ix) {
+		if(!bp->count[ix]) continue;
+		env[ix] = (float)bp->sum[ix] / bp->count[ix];
+		for(int jx = last + 1; last >= 0 && jx < ix; ++jx)
+			env[jx] = env[last] + (env[ix] - env[last]) * (jx - last) / (ix - last);
+		last = ix;
+	}
+
+	float prev = env[lo];
+	for(int ix = lo + 1; ix < hi; ++ix) {
+		float cur = env[ix];
+		env[ix] = (prev + 2 * cur + env[ix + 1]) * 0.25f;
+		prev = cur;
+	}
+
+	int peak = lo;
+	for(int ix = lo + 1; ix <= hi; ++ix)
+		if(env[ix] > env[peak]) peak = ix;
+	if(peak == lo || peak == hi || env[peak] <= 0) return BP_FAILED;
+
+	float a = env[peak - 1], b = env[peak], c = env[peak + 1];
+	float curve = a - 2 * b + c, offset = 0;
+	if(curve < 0) offset = 0.5f * (a - c) / curve;
+	float mean = BIN_CENTER(peak) + offset * BP_BIN_MMHG;
+
+	float target = bp->config.systolic_ratio * b, systolic = -1;
+	for(int ix = peak + 1; ix <= hi && systolic < 0; ++ix)
+		if(env[ix] <= target)
+			systolic = BIN_CENTER(ix - 1) + BP_BIN_MMHG *
+				(env[ix - 1] - target) / (env[ix - 1] - env[ix]);
+
+	target = bp->config.diastolic_ratio * b;
+	float diastolic = -1;
+	for(int ix = peak - 1; ix >= lo && diastolic < 0; --ix)
+		if(env[ix] <= target)
+			diastolic = BIN_CENTER(ix + 1) - BP_BIN_MMHG *
+				(env[ix + 1] - target) / (env[ix + 1] - env[ix]);
+
+	if(systolic < 0 || diastolic < 0) return BP_FAILED;
+	bp->result.sistolic = (int)(systolic + 0.5f);
+	bp->result.diastolic = (int)(diastolic + 0.5f);
+	bp->result.mean = (int)(mean + 0.5f);
+	return BP_DONE;
+}
+
+//----------------------------------------------------------------------
+//	one update, pressure in mmHg, returns the state after it
+//----------------------------------------------------------------------
+BpState bp_update(BpEngine* bp, int pressure, int amplitude) {
+	const BpConfig* cfg = &bp->config;
+
+	switch(bp->state) {
+		case BP_IDLE:
+		case BP_DONE:
+		case BP_FAILED:
+			if(pressure > cfg->start_mmHg) {
+				bp->top = pressure;
+				bp->state = BP_INFLATING;
+			}
+			break;
+
+		case BP_INFLATING:
+			if(pressure > bp->top)
+				bp->top = pressure;
+			else if(pressure <= cfg->stop_mmHg)
+				bp->state = BP_IDLE;				//dumped, nothing to measure
+			else if(pressure <= bp->top - cfg->deflate_mmHg)
+				start_deflation(bp, pressure);
+			break;
+
+		case BP_DEFLATING:
+			if(pressure <= cfg->stop_mmHg) {
+				bp->state = finish(bp);
+				break;
+			}
+			if(pressure > bp->bottom + cfg->deflate_mmHg) {	//pumped up again
+				bp->top = pressure;
+				bp->state = BP_INFLATING;
+				break;
+			}
+			if(pressure < bp->bottom) bp->bottom = pressure;
+			if(amplitude > bp->peak) bp->peak = amplitude;
+			if(++bp->ticks >= bp->block_ticks) end_block(bp, pressure);
+			break;
+	}
+	return bp->state;
+}
+
+// copies out the last estimate, returns 0 while there is none
+int bp_result(const BpEngine* bp, PulseInfo* info) {
+	if(bp->state != BP_DONE) return 0;
+	*info = bp->result;
+	return 1;
+}
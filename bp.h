@@ -0,0 +1,70 @@
+/**********************************************************************/
+//	bp.h   October 17, 2026
+/***********************************************************************
+	Streaming oscillometric blood pressure estimate. bp_update() takes
+	the cuff pressure and the oscillation amplitude at rate_hz. It
+	waits for the cuff to be pumped past start_mmHg. Once the cuff is
+	deflating, the peak amplitude over the last 1.5 s, long enough to
+	hold a beat down to 40 bpm, is averaged into 2 mmHg pressure bins
+	against the pressure halfway through that window. When the cuff is
+	down to stop_mmHg, the binned envelope gives:
+
+	  MAP			the pressure at the envelope peak
+	  systolic		above MAP, where the envelope falls to systolic_ratio
+	  diastolic		below MAP, where the envelope falls to diastolic_ratio
+
+	Memory is fixed. An update costs a compare, every 125 ms one also
+	takes the maximum of BP_BLOCKS blocks and updates a bin, and the one
+	update that finishes a measurement walks the bins a few times.
+***********************************************************************/
+#ifndef BP_H
+#define BP_H
+
+#include "library.h"
+
+#define BP_BIN_MMHG		2
+#define BP_BINS			128			// 0 .. 255 mmHg
+#define BP_BLOCKS		12			// of 125 ms, peak hold window of 1.5 s
+
+typedef enum {
+	BP_IDLE,			// cuff below start_mmHg
+	BP_INFLATING,		// pressure still rising
+	BP_DEFLATING,		// collecting the envelope
+	BP_DONE,			// estimate ready, see bp_result()
+	BP_FAILED			// the envelope had no usable peak or edges
+} BpState;
+
+typedef struct {
+	float rate_hz;			// bp_update() calls per second
+	int start_mmHg;			// a measurement starts above this
+	int stop_mmHg;			// and ends when deflation gets down to this
+	int deflate_mmHg;		// drop from the top that counts as deflating
+	float systolic_ratio;	// fraction of the peak amplitude at systolic
+	float diastolic_ratio;	// and at diastolic
+} BpConfig;
+
+typedef struct {
+	BpConfig config;
+	BpState state;
+	int top;				// highest pressure while inflating
+	int bottom;				// lowest pressure while deflating
+	int lo, hi;				// bins touched while deflating
+	int block_max[BP_BLOCKS];		// amplitude peak of each block
+	int block_pressure[BP_BLOCKS];	// and the pressure as it ended
+	int block;				// next block_max slot
+	int blocks;				// blocks filled, up to BP_BLOCKS
+	int block_ticks;		// updates per block, rate_hz / 8
+	int ticks;				// into the current block
+	int peak;				// amplitude peak so far in it
+	long long sum[BP_BINS];
+	unsigned int count[BP_BINS];
+	float envelope[BP_BINS];
+	PulseInfo result;
+} BpEngine;
+
+void bp_default_config(BpConfig* config);
+void bp_init(BpEngine* bp, const BpConfig* config);
+BpState bp_update(BpEngine* bp, int pressure, int amplitude);
+int  bp_result(const BpEngine* bp, PulseInfo* info);
+
+#endif /* BP_H */
@@ -0,0 +1,34 @@
+/**********************************************************************/
+//	dma.c   October 17, 2026
+/***********************************************************************
+	BCM2835 DMA controller. A channel is pointed at a chain of control
+	blocks in memory and then runs on its own; the CPU only has to
+	check DMA_CS for ACTIVE/END later on.
+***********************************************************************/
+#include "dma.h"
+#include "peripheral.h"
+#include "hal.h"
+
+//----------------------------------------------------------------------
+void dma_init(unsigned int channel) {
+	PUT32(DMA_ENABLE, GET32(DMA_ENABLE) | (1 << channel));
+	PUT32(DMA_CHAN(channel) + DMA_CS, DMA_CS_RESET);
+	PUT32(DMA_CHAN(channel) + DMA_DEBUG, 0x7);		//clear error flags
+}
+
+//----------------------------------------------------------------------
+void dma_start(unsigned int channel, unsigned int cb_bus_addr) {
+	PUT32(DMA_CHAN(channel) + DMA_CS, DMA_CS_END | DMA_CS_INT);	//clear
+	PUT32(DMA_CHAN(channel) + DMA_CONBLK_AD, cb_bus_addr);
+	PUT32(DMA_CHAN(channel) + DMA_CS, DMA_CS_ACTIVE);
+}
+
+//----------------------------------------------------------------------
+int dma_busy(unsigned int channel) {
+	return GET32(DMA_CHAN(channel) + DMA_CS) & DMA_CS_ACTIVE;
+}
+
+//----------------------------------------------------------------------
+int dma_error(unsigned int channel) {
+	return (GET32(DMA_CHAN(channel) + DMA_CS) & DMA_CS_ERROR) != 0;
+}
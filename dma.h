@@ -0,0 +1,45 @@
+/**********************************************************************/
+//	dma.h   October 17, 2026
+/**********************************************************************/
+#ifndef DMA_H
+#define DMA_H
+
+// transfer information bits, DMA_TI
+#define DMA_TI_INTEN		(1 << 0)
+#define DMA_TI_WAIT_RESP	(1 << 3)
+#define DMA_TI_DEST_INC		(1 << 4)
+#define DMA_TI_DEST_DREQ	(1 << 6)
+#define DMA_TI_SRC_INC		(1 << 8)
+#define DMA_TI_SRC_DREQ		(1 << 10)
+#define DMA_TI_PERMAP(n)	((n) << 16)
+#define DMA_TI_WAITS(n)		((n) << 21)
+#define DMA_TI_NO_WIDE		(1 << 26)
+
+// peripheral DREQ numbers for DMA_TI_PERMAP
+#define DMA_DREQ_SPI_TX		6
+#define DMA_DREQ_SPI_RX		7
+
+// channel status bits, DMA_CS
+#define DMA_CS_ACTIVE		(1 << 0)
+#define DMA_CS_END			(1 << 1)
+#define DMA_CS_INT			(1 << 2)
+#define DMA_CS_ERROR		(1 << 8)
+#define DMA_CS_RESET		(1u << 31)
+
+// control blocks must sit on a 32 byte boundary
+typedef struct {
+	unsigned int ti;
+	unsigned int source_ad;
+	unsigned int dest_ad;
+	unsigned int txfr_len;
+	unsigned int stride;
+	unsigned int nextconbk;
+	unsigned int reserved[2];
+} __attribute__((aligned(32))) DmaControlBlock;
+
+void dma_init(unsigned int channel);
+void dma_start(unsigned int channel, unsigned int cb_bus_addr);
+int  dma_busy(unsigned int channel);
+int  dma_error(unsigned int channel);
+
+#endif /* DMA_H */
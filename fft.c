@@ -0,0 +1,177 @@
+/**********************************************************************/
+//	fft.c   October 17, 2026
+/***********************************************************************
+	Fixed point FFT, see fft.h. The complex transform is decimation in
+	time: a bit reversal permutation, then log2 n passes of butterflies
+	with the twiddle for each group looked up once. A twiddle product
+	is taken in 64 bits and rounded back to the data's scale.
+
+	The real transform splits the n/2 point result Z of the packed
+	samples into the n point result X with
+	  X[k] = (Z[k] + Z*[m-k] - j W^k (Z[k] - Z*[m-k])) / 2,  m = n/2
+	working from both ends at once, since X[m-k] comes out of the same
+	two values as X[k].
+***********************************************************************/
+#include "fft.h"
+#include "fixed.h"
+#include "library.h"
+#include "uart.h"
+#include "math.h"
+
+static int16_t	cos_table[FFT_MAX / 2];		// cos(2 pi k / FFT_MAX), Q15
+static int16_t	sin_table[FFT_MAX / 2];
+static uint16_t	reversed[FFT_MAX];			// FFT_MAX_LOG2 bits reversed
+static int		ready = 0;
+
+//----------------------------------------------------------------------
+void fft_init(void) {
+	if(ready) return;
+	for(int k = 0; k < FFT_MAX / 2; ++k) {		//BAM, 0x10000 is 2 pi
+		cos_table[k] = icos((int16_t)(k << (16 - FFT_MAX_LOG2)));
+		sin_table[k] = isin((int16_t)(k << (16 - FFT_MAX_LOG2)));
+	}
+	for(int ix = 0; ix < FFT_MAX; ++ix) {
+		unsigned int r = 0;
+		for(int bit = 0; bit < FFT_MAX_LOG2; ++bit)
+			r |= ((ix >> bit) & 1) << (FFT_MAX_LOG2 - 1 - bit);
+		reversed[ix] = r;
+	}
+	ready = 1;
+}
+
+static inline int32_t twiddle_mul(int32_t a, int16_t w) {
+	return (int32_t)(((int64_t)a * w + 0x4000) >> 15);
+}
+
+// any size up to FFT_MAX, the public entry points check the range
+static void transform(FftComplex* x, int log2n) {
+	int n = 1 << log2n;
+	int shift = FFT_MAX_LOG2 - log2n;
+
+	for(int ix = 0; ix < n; ++ix) {
+		int jx = reversed[ix] >> shift;
+		if(ix < jx) {
+			FftComplex t = x[ix];
+			x[ix] = x[jx];
+			x[jx] = t;
+		}
+	}
+
+	for(int half = 1, step = FFT_MAX / 2; half < n; half <<= 1, step >>= 1) {
+		for(int jx = 0; jx < half; ++jx) {
+			int16_t c = cos_table[jx * step];		//W = c - j s
+			int16_t s = sin_table[jx * step];
+			for(int ix = jx; ix < n; ix += 2 * half) {
+				FftComplex* a = &x[ix];
+				FftComplex* b = &x[ix + half];
+				int32_t tr = twiddle_mul(b->re, c) + twiddle_mul(b->im, s);
+				int32_t ti = twiddle_mul(b->im, c) - twiddle_mul(b->re, s);
+				b->re = a->re - tr;
+				b->im = a->im - ti;
+				a->re += tr;
+				a->im += ti;
+			}
+		}
+	}
+}
+
+// 0, or -1 for a size out of range
+int fft_complex(FftComplex* x, int log2n) {
+	if(log2n < FFT_MIN_LOG2 || log2n > FFT_MAX_LOG2) return -1;
+	transform(x, log2n);
+	return 0;
+}
+
+int fft_real(FftComplex* x, int log2n) {
+	if(log2n < FFT_MIN_LOG2 || log2n > FFT_MAX_LOG2) return -1;
+	int m = 1 << (log2n - 1);
+	int step = 1 << (FFT_MAX_LOG2 - log2n);
+
+	transform(x, log2n - 1);
+
+	int32_t z_re = x[0].re, z_im = x[0].im;
+	x[0].re = z_re + z_im;					//bins 0 and n/2
+	x[0].im = z_re - z_im;
+	x[m / 2].im = -x[m / 2].im;				//W^(n/4) is -j
+
+	for(int k = 1; k < m / 2; ++k) {
+		FftComplex* a = &x[k];
+		FftComplex* b = &x[m - k];
+		int32_t er = a->re + b->re, ei = a->im - b->im;		//Z[k] + Z*[m-k]
+		int32_t dr = a->re - b->re, di = a->im + b->im;		//Z[k] - Z*[m-k]
+		int16_t c = cos_table[k * step];
+		int16_t s = sin_table[k * step];
+		int32_t tr = twiddle_mul(dr, c) + twiddle_mul(di, s);	//W^k (Z[k] - Z*[m-k])
+		int32_t ti = twiddle_mul(di, c) - twiddle_mul(dr, s);
+		a->re = (er + ti) >> 1;
+		a->im = (ei - tr) >> 1;
+		b->re = (er - ti) >> 1;
+		b->im = -((ei + tr) >> 1);
+	}
+	return 0;
+}
+
+//----------------------------------------------------------------------
+//	the last n samples of an int16 ring under a periodic Hann window,
+//	packed for fft_real(). The window is 1 - cos, halved, and cos over
+//	the second half of the window mirrors the first.
+//----------------------------------------------------------------------
+int fft_load_ring(FftComplex* x, const Ring* r, int log2n) {
+	RingSpan span[2];
+	int n = 1 << log2n;
+	int step = 1 << (FFT_MAX_LOG2 - log2n);
+
+	if(log2n < FFT_MIN_LOG2 || log2n > FFT_MAX_LOG2 || r->size < (unsigned int)n) return -1;
+	int spans = ring_window(r, n, span);
+	int ix = 0;
+	for(int sx = 0; sx < spans; ++sx) {
+		const int16_t* in = span[sx].data;
+		for(unsigned int jx = 0; jx < span[sx].count; ++jx, ++ix) {
+			int k = ix < n / 2 ? ix : n - ix;
+			int32_t w = k == n / 2 ? 0x8000 : (0x8000 - cos_table[k * step]) >> 1;
+			int32_t v = (in[jx] * w + 0x4000) >> 15;
+			if(ix & 1) x[ix >> 1].im = v;
+			else x[ix >> 1].re = v;
+		}
+	}
+	return 0;
+}
+
+// n/2 + 1 magnitudes of a real transform
+void fft_magnitude(const FftComplex* x, int log2n, uint32_t* mag) {
+	int m = 1 << (log2n - 1);
+
+	mag[0] = abs(x[0].re);
+	mag[m] = abs(x[0].im);
+	for(int k = 1; k < m; ++k)
+		mag[k] = isqrt64((uint64_t)((int64_t)x[k].re * x[k].re)
+			+ (uint64_t)((int64_t)x[k].im * x[k].im));
+}
+
+// the strongest bin above DC
+int fft_peak(const uint32_t* mag, int log2n) {
+	int m = 1 << (log2n - 1), peak = 1;
+	for(int k = 2; k <= m; ++k)
+		if(mag[k] > mag[peak]) peak = k;
+	return peak;
+}
+
+//----------------------------------------------------------------------
+//	"mic_one peak 62 Hz 48213 of 129 bins, 3 Hz each" over the UART
+//----------------------------------------------------------------------
+void fft_report(const char* name, const uint32_t* mag, int log2n, unsigned int rate_hz) {
+	char line[96];
+	int peak = fft_peak(mag, log2n);
+
+	char* p = put_str(line, name);
+	p = put_str(p, " peak ");
+	p = put_uint(p, (peak * rate_hz) >> log2n);
+	p = put_str(p, " Hz ");
+	p = put_uint(p, mag[peak]);
+	p = put_str(p, " of ");
+	p = put_uint(p, (1 << (log2n - 1)) + 1);
+	p = put_str(p, " bins, ");
+	p = put_uint(p, rate_hz >> log2n);
+	p = put_str(p, " Hz each\r\n");
+	uart_put_line(line, p);
+}
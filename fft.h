@@ -0,0 +1,44 @@
+/**********************************************************************/
+//	fft.h   October 17, 2026
+/***********************************************************************
+	In-place radix-2 fixed point FFT, 64 to FFT_MAX points. The data is
+	int32 with Q15 twiddles and is not scaled between stages, so an
+	n point transform of inputs below 2^(30 - log2 n) cannot overflow
+	and 16 bit samples fit at every size. The twiddle and bit reversal
+	tables are built once by fft_init() from isin/icos, for FFT_MAX
+	points, and smaller sizes step through them.
+
+	fft_real() transforms n real samples packed two to a complex value,
+	even samples in re and odd in im, through an n/2 point complex
+	transform and a split pass. Bins 0 to n/2 - 1 come back in place,
+	except that bin n/2, which is real like bin 0, goes in x[0].im.
+	fft_load_ring() packs the last n samples of an int16 Ring that way
+	under a Hann window, straight from the ring's spans.
+
+	Every bin is the unnormalised DFT sum, so a full scale sine of
+	amplitude A in bin k gives about A * n / 4 under the window.
+***********************************************************************/
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdint.h>
+#include "ring.h"
+
+#define FFT_MIN_LOG2	6
+#define FFT_MAX_LOG2	10
+#define FFT_MAX			(1 << FFT_MAX_LOG2)
+
+typedef struct {
+	int32_t re;
+	int32_t im;
+} FftComplex;
+
+void fft_init(void);
+int  fft_complex(FftComplex* x, int log2n);
+int  fft_real(FftComplex* x, int log2n);
+int  fft_load_ring(FftComplex* x, const Ring* r, int log2n);
+void fft_magnitude(const FftComplex* x, int log2n, uint32_t* mag);
+int  fft_peak(const uint32_t* mag, int log2n);
+void fft_report(const char* name, const uint32_t* mag, int log2n, unsigned int rate_hz);
+
+#endif /* FFT_H */
@@ -0,0 +1,139 @@
+/**********************************************************************/
+//	fixed.c   October 17, 2026
+/***********************************************************************
+	Q15/Q31 signal path, see fixed.h. The mean and deviation follow
+	DetermineAverage/DetermineDeviation and ZScoreUpdateQ31 follows
+	ZScoreUpdate step for step, so the two paths can be compared
+	sample by sample on the host.
+
+	The detector lag and the n - 1 of the sample deviation are not
+	powers of two, so the 64 bit divides stay divides. On the ARM they
+	are __aeabi_ldivmod and __aeabi_uldivmod, from the libgcc the
+	makefile links into kernel.elf.
+***********************************************************************/
+#include "fixed.h"
+
+//----------------------------------------------------------------------
+//	floor(sqrt(x)), one result bit per iteration starting from the top
+//	set bit of x, with no data dependent branches in the loop
+//----------------------------------------------------------------------
+uint32_t isqrt64(uint64_t x) {
+	uint64_t root = 0;
+
+	if(x == 0) return 0;
+	uint64_t bit = (uint64_t)1 << ((63 - __builtin_clzll(x)) & ~1);
+	while(bit) {
+		uint64_t trial = root + bit;
+		uint64_t take = -(uint64_t)(x >= trial);
+		x -= trial & take;
+		root = (root >> 1) + (bit & take);
+		bit >>= 2;
+	}
+	return (uint32_t)root;
+}
+
+//----------------------------------------------------------------------
+//	sample deviation of n values from the sum and the sum of squares of
+//	the values >> Q31_STAT_SHIFT. With sum = q*n + r the squared sum
+//	over n is q*q*n + 2*q*r + r*r/n, which keeps every term in 64 bits.
+//	The difference is never negative, so unsigned wraparound in the
+//	intermediate terms cancels out.
+//----------------------------------------------------------------------
+static q31_t deviation(int64_t shifted_sum, uint64_t shifted_squares, int n) {
+	int64_t q = shifted_sum / n;
+	int64_t r = shifted_sum % n;
+	uint64_t dev_sqr_sum = shifted_squares - (uint64_t)(q * q * n)
+		- (uint64_t)(2 * q * r) - (uint64_t)((int32_t)(r * r) / n);
+
+	if(dev_sqr_sum == 0) return 0;
+	uint64_t var = dev_sqr_sum / (n - 1);
+	uint32_t std = isqrt64(var << (2 * Q31_STAT_SHIFT));	// back to Q31
+	return std > Q31_MAX ? Q31_MAX : (q31_t)std;
+}
+
+static int64_t rounded_div(int64_t sum, int n) {
+	return (sum >= 0 ? sum + n / 2 : sum - n / 2) / n;
+}
+
+//----------------------------------------------------------------------
+void InitRingBufferQ31(RingBufferQ31* buffer) {
+	buffer->Write_Index = 0;
+	buffer->Sum = 0;
+	buffer->ShiftedSum = 0;
+	buffer->ShiftedSquares = 0;
+	memset(buffer->Buffer, 0, sizeof(buffer->Buffer));
+}
+
+void WriteToRingBufferQ31(RingBufferQ31* buffer, q31_t val) {
+	q31_t old = buffer->Buffer[buffer->Write_Index];
+	int64_t s = val >> Q31_STAT_SHIFT;
+	int64_t s_old = old >> Q31_STAT_SHIFT;
+
+	buffer->Buffer[buffer->Write_Index] = val;
+	buffer->Sum += (int64_t)val - old;
+	buffer->ShiftedSum += s - s_old;
+	buffer->ShiftedSquares += (uint64_t)(s * s) - (uint64_t)(s_old * s_old);
+
+	if(++buffer->Write_Index == RINGBUFFER_SIZE) buffer->Write_Index = 0;
+}
+
+q31_t DetermineAverageQ31(const RingBufferQ31* buffer) {
+	return (q31_t)rounded_div(buffer->Sum, RINGBUFFER_SIZE);
+}
+
+q31_t DetermineDeviationQ31(const RingBufferQ31* buffer) {
+	return deviation(buffer->ShiftedSum, buffer->ShiftedSquares, RINGBUFFER_SIZE);
+}
+
+//----------------------------------------------------------------------
+void InitZScoreQ31(ZScoreQ31* det, int lag, float threshold, float influence) {
+	if(lag < 2) lag = 2;
+	if(lag > ZSCORE_MAX_LAG) lag = ZSCORE_MAX_LAG;
+	if(influence < 0) influence = 0;
+	if(influence > 1) influence = 1;
+
+	det->lag = lag;
+	det->threshold = (int32_t)(threshold * 65536.0f + 0.5f);
+	det->influence = (int32_t)(influence * 32768.0f + 0.5f);
+	det->index = 0;
+	det->count = 0;
+	det->sum = det->shifted_sum = 0;
+	det->shifted_squares = 0;
+	memset(det->filtered, 0, lag * sizeof(det->filtered[0]));
+}
+
+// Returns 1 for a sample above the band, -1 below it and 0 inside it.
+// Nothing is signalled until the first lag samples have been seen.
+int ZScoreUpdateQ31(ZScoreQ31* det, q31_t y) {
+	int signal = 0;
+	q31_t value = y;
+
+	if(det->count >= det->lag) {
+		int64_t avg = rounded_div(det->sum, det->lag);
+		int64_t std = deviation(det->shifted_sum, det->shifted_squares, det->lag);
+		int64_t diff = (int64_t)y - avg;
+
+		// |y - avg| > threshold * std with threshold in Q16.16
+		if((diff < 0 ? -diff : diff) << 16 > det->threshold * std) {
+			signal = diff > 0 ? 1 : -1;
+			int last = (det->index == 0 ? det->lag : det->index) - 1;
+			int64_t mix = (int64_t)det->influence * y
+				+ (int64_t)(0x8000 - det->influence) * det->filtered[last];
+			value = q31_sat((mix + 0x4000) >> 15);
+		}
+	} else {
+		det->count++;
+	}
+
+	q31_t old = det->filtered[det->index];
+	int64_t s = value >> Q31_STAT_SHIFT;
+	int64_t s_old = old >> Q31_STAT_SHIFT;
+
+	det->filtered[det->index] = value;
+	det->sum += (int64_t)value - old;
+	det->shifted_sum += s - s_old;
+	det->shifted_squares += (uint64_t)(s * s) - (uint64_t)(s_old * s_old);
+
+	if(++det->index == det->lag) det->index = 0;
+	return signal;
+}
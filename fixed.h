@@ -0,0 +1,108 @@
+/**********************************************************************/
+//	fixed.h   October 17, 2026
+/***********************************************************************
+	Q15/Q31 fixed point versions of the per-tick signal path: the
+	microphone product, the window mean and deviation, and the z-score
+	peak detector. Everything is integer with saturating arithmetic, so
+	the ARM and the host build give the same results bit for bit.
+
+	The microphone words are Q15, their product is Q31. The statistics
+	keep exact 64 bit sums, so unlike the float versions they do not
+	drift and need no resync. Squares are taken of the samples shifted
+	down by Q31_STAT_SHIFT so a window of up to 512 fits in 64 bits.
+***********************************************************************/
+#ifndef FIXED_H
+#define FIXED_H
+
+#include <stdint.h>
+#include "library.h"
+#include "math.h"
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+#define Q15_MAX		0x7FFF
+#define Q15_MIN		(-0x8000)
+#define Q31_MAX		0x7FFFFFFF
+#define Q31_MIN		(-0x7FFFFFFF - 1)
+
+#define Q31_STAT_SHIFT	4
+
+//----------------------------------------------------------------------
+//	saturating primitives
+//----------------------------------------------------------------------
+static inline q15_t q15_sat(int32_t x) {
+	if(x > Q15_MAX) return Q15_MAX;
+	if(x < Q15_MIN) return Q15_MIN;
+	return (q15_t)x;
+}
+
+static inline q31_t q31_sat(int64_t x) {
+	if(x > Q31_MAX) return Q31_MAX;
+	if(x < Q31_MIN) return Q31_MIN;
+	return (q31_t)x;
+}
+
+static inline q15_t q15_add(q15_t a, q15_t b) {
+	return q15_sat((int32_t)a + b);
+}
+
+static inline q31_t q31_add(q31_t a, q31_t b) {
+	return q31_sat((int64_t)a + b);
+}
+
+static inline q31_t q31_sub(q31_t a, q31_t b) {
+	return q31_sat((int64_t)a - b);
+}
+
+// Q15 x Q15, the full product as Q31. Only -1 x -1 saturates.
+static inline q31_t q15_mul_q31(q15_t a, q15_t b) {
+	return q31_sat((int64_t)((int32_t)a * b) << 1);
+}
+
+static inline q15_t q15_mul(q15_t a, q15_t b) {
+	return q15_sat(((int32_t)a * b + 0x4000) >> 15);
+}
+
+static inline q31_t q31_mul(q31_t a, q31_t b) {
+	return q31_sat(((int64_t)a * b + 0x40000000) >> 31);
+}
+
+uint32_t isqrt64(uint64_t x);
+
+//----------------------------------------------------------------------
+//	window statistics, the Q31 counterpart of RingBuffer
+//----------------------------------------------------------------------
+typedef struct {
+	q31_t Buffer[RINGBUFFER_SIZE];
+	int Write_Index;
+	int64_t Sum;			// of the samples
+	int64_t ShiftedSum;		// of the samples >> Q31_STAT_SHIFT
+	uint64_t ShiftedSquares;	// of the squares of those
+} RingBufferQ31;
+
+void InitRingBufferQ31(RingBufferQ31* buffer);
+void WriteToRingBufferQ31(RingBufferQ31* buffer, q31_t val);
+q31_t DetermineAverageQ31(const RingBufferQ31* buffer);
+q31_t DetermineDeviationQ31(const RingBufferQ31* buffer);
+
+//----------------------------------------------------------------------
+//	streaming z-score detector, the Q31 counterpart of ZScoreDetector.
+//	threshold is Q16.16 and influence is Q15 with 1.0 as 0x8000.
+//----------------------------------------------------------------------
+typedef struct {
+	q31_t filtered[ZSCORE_MAX_LAG];
+	int index;
+	int count;
+	int lag;
+	int32_t threshold;
+	int32_t influence;
+	int64_t sum;
+	int64_t shifted_sum;
+	uint64_t shifted_squares;
+} ZScoreQ31;
+
+void InitZScoreQ31(ZScoreQ31* det, int lag, float threshold, float influence);
+int ZScoreUpdateQ31(ZScoreQ31* det, q31_t y);
+
+#endif /* FIXED_H */
@@ -0,0 +1,92 @@
+/**********************************************************************/
+//	hal.h   October 17, 2026
+/***********************************************************************
+	Hardware abstraction layer. Every register access in the firmware
+	goes through these accessors. On the Pi Zero they are the assembler
+	stubs at the bottom of startup.s. On the host build (HOST_BUILD)
+	hal_host.c implements them against mock register banks, so the
+	acquisition and signal path can be run and timed on a dev box.
+***********************************************************************/
+#ifndef HAL_H
+#define HAL_H
+
+void PUT32(unsigned int, unsigned int);
+unsigned int GET32(unsigned int);
+void PUT16(unsigned int, unsigned int);
+unsigned int GET16(unsigned int);
+void PUT8(unsigned int, unsigned char);
+unsigned char GET8(unsigned int);
+void dummy(unsigned int);
+void enable_irq(void);
+void disable_irq(void);
+
+//----------------------------------------------------------------------
+//	free running cycle count for profiling. On the Pi Zero this is the
+//	ARM1176 CCNT, started at reset by startup.s. The host has no cycle
+//	counter to read, it returns CLOCK_MONOTONIC nanoseconds instead.
+//----------------------------------------------------------------------
+unsigned int hal_cycles(void);
+
+//----------------------------------------------------------------------
+//	VC bus address of memory a DMA engine reads or writes. The target
+//	uses the 0x40000000 alias of SDRAM. On the Pi 1/Zero the ARM's own
+//	accesses go through the VideoCore L2, and this alias keeps the DMA
+//	engine coherent with it. The uncached 0xC0000000 alias bypasses the
+//	L2 and can read stale lines or lose ones the ARM still has there.
+//	The ARM's L1 still needs the maintenance below. The host hands out
+//	synthetic bus addresses for the regions it has been shown, so a
+//	whole buffer should be mapped once before addressing its parts.
+//----------------------------------------------------------------------
+#ifndef HOST_BUILD
+static inline unsigned int hal_bus_addr(const volatile void* ptr, unsigned int size) {
+	(void)size;
+	return (unsigned int)ptr | 0x40000000;
+}
+#else
+unsigned int hal_bus_addr(const volatile void* ptr, unsigned int size);
+#endif
+
+//----------------------------------------------------------------------
+//	L1 data cache maintenance around DMA, see mmu.c. Clean writes dirty
+//	lines back before the DMA engine reads memory the CPU wrote. Invalidate
+//	drops lines before the CPU reads memory the DMA engine wrote, and
+//	must only be given whole 32 byte lines the CPU does not write. The
+//	host has no cache in the way, both are no-ops there.
+//----------------------------------------------------------------------
+#ifndef HOST_BUILD
+void mmu_init(void);
+void hal_cache_clean(const volatile void* ptr, unsigned int size);
+void hal_cache_invalidate(const volatile void* ptr, unsigned int size);
+#else
+static inline void hal_cache_clean(const volatile void* ptr, unsigned int size) {
+	(void)ptr; (void)size;
+}
+static inline void hal_cache_invalidate(const volatile void* ptr, unsigned int size) {
+	(void)ptr; (void)size;
+}
+#endif
+
+#ifdef HOST_BUILD
+//----------------------------------------------------------------------
+//	mock register bank control, host build only
+//----------------------------------------------------------------------
+// SPI devices modelled behind the mock SPI0 block
+#define HAL_SPI_MIC_ONE	0	// selected by GPIO7 (CE1)
+#define HAL_SPI_MIC_TWO	1	// selected by GPIO8 (CE0)
+#define HAL_SPI_CUFF		2	// MAX187, selected by GPIO25
+#define HAL_SPI_DEVICES	3
+
+void hal_host_reset(void);
+void hal_host_spi_sample(unsigned int device, unsigned int value);
+void hal_host_timer_match(unsigned int channel);
+unsigned int hal_host_uart_tx_count(void);
+void hal_host_uart_rx(unsigned char c);
+void hal_host_gpio_level(unsigned int pin, unsigned int state);
+unsigned long long hal_host_nanos(void);
+void hal_host_clock_advance(unsigned int us);
+void hal_host_uart_sink(void (*sink)(unsigned char));
+int hal_host_sd_image(const char* path);
+void hal_host_dma_run(void);
+#endif
+
+#endif /* HAL_H */
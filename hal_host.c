@@ -0,0 +1,620 @@
+/**********************************************************************/
+//	hal_host.c   October 17, 2026
+/***********************************************************************
+	Host implementation of hal.h. Each BCM2835 peripheral window the
+	firmware touches is backed by a plain array of 32-bit registers.
+	A handful of registers get side effects so the drivers behave as
+	they do on the Pi Zero:
+
+	  CLO/CHI         free running 1MHz counter from CLOCK_MONOTONIC, or
+	                  a virtual clock once hal_host_clock_advance() has
+	                  been called
+	  C0-C3           on the virtual clock, CLO passing a compare value
+	                  sets its match bit in CS
+	  CS              write one to clear the match bits
+	  IRQ_PEND1       mirrors the timer match bits in CS
+	  GPSET0/GPCLR0   drive GPLEV0
+	  SPI_CS          TXD/DONE always set, RXD set while data is queued
+	  SPI_FIFO        each byte written shifts a byte out of the device
+	                  selected by its chip select pin
+	  AUX_MU_IO_REG   transmit bytes go into an 8 byte FIFO that drains
+	                  at the rate AUX_MU_BAUD_REG sets, on the same
+	                  clock as CLO, into an optional byte sink,
+	                  receive bytes come from the injection queue
+	  AUX_MU_LSR/STAT data ready and FIFO space from the above, and
+	                  IRQ_PEND1 bit 29 follows AUX_MU_IER_REG
+	  DMA CS          ACTIVE starts the channel, the control block chain
+	                  is walked by hal_host_dma_run() as if the engine
+	                  ran between ticks
+	  EMMC            an SD card backed by the image file given to
+	                  hal_host_sd_image(), without one every command
+	                  times out. Commands complete at once and data
+	                  moves a word at a time through EMMC_DATA. After
+	                  its last block a write stays busy for a modelled
+	                  programming time on the clock, with a long stall
+	                  every SD_STALL_EVERY writes as a card's flash
+	                  housekeeping would. Each poll of a busy card
+	                  costs a microsecond of virtual time, so a blocking
+	                  wait comes to an end.
+
+	With DMAEN set in SPI_CS a FIFO word carries up to four bytes,
+	bounded by SPI_DLEN, as on the real block.
+***********************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "hal.h"
+#include "peripheral.h"
+#include "dma.h"
+
+#define BANK_WORDS	0x400		// 4K window per peripheral
+
+typedef struct {
+	unsigned int base;
+	uint32_t reg[BANK_WORDS];
+} RegisterBank;
+
+static RegisterBank banks[] = {
+	{ 0x20003000 },		// system timer
+	{ 0x20007000 },		// DMA controller
+	{ 0x2000B000 },		// interrupt controller
+	{ 0x20200000 },		// GPIO
+	{ 0x20204000 },		// SPI0
+	{ 0x20215000 },		// AUX mini UART
+	{ 0x20300000 },		// EMMC
+};
+#define NUM_BANKS (sizeof(banks) / sizeof(banks[0]))
+
+#define SPI_RX_QUEUE 16
+static unsigned int spi_sample[HAL_SPI_DEVICES];
+static unsigned int spi_index;
+static unsigned char spi_rx[SPI_RX_QUEUE];
+static unsigned int spi_rx_head, spi_rx_tail;
+
+static unsigned int spi_dlen;
+
+#define UART_RX_QUEUE 256
+static unsigned char uart_rx[UART_RX_QUEUE];
+static unsigned int uart_rx_head, uart_rx_tail;
+static unsigned int uart_tx_count;
+static unsigned int uart_tx_level;
+static uint64_t uart_tx_drained;
+static void (*uart_sink)(unsigned char);
+
+static int virtual_clock = 0;
+static uint64_t virtual_ns = 0;
+
+#define SD_BUSY_US		800		// programming time per write command
+#define SD_BLOCK_US		25		// and per block, about 20MB/s
+#define SD_STALL_EVERY	64
+#define SD_STALL_US		30000
+
+#define EMMC_INT_CMD_DONE	0x00000001
+#define EMMC_INT_DATA_DONE	0x00000002
+#define EMMC_INT_WRITE_RDY	0x00000010
+#define EMMC_INT_READ_RDY	0x00000020
+#define EMMC_INT_TIMEOUT	0x00018000		// ERR and CTO_ERR
+
+typedef enum { EMMC_IDLE, EMMC_READ, EMMC_WRITE, EMMC_PROGRAM } EmmcState;
+
+static FILE* sd_image = 0;
+static struct {
+	EmmcState state;
+	int app;					// the last command was CMD55
+	unsigned int lba;
+	unsigned int blocks;
+	unsigned int done;			// blocks moved
+	unsigned int word;			// within the block
+	uint32_t block[128];
+	uint64_t busy_until;		// us
+	unsigned int writes;
+} emmc;
+
+//----------------------------------------------------------------------
+static uint32_t* reg(unsigned int addr) {
+	static uint32_t scratch;
+	for(unsigned int ix = 0; ix < NUM_BANKS; ++ix) {
+		unsigned int offset = addr - banks[ix].base;
+		if(offset < BANK_WORDS * 4)
+			return &banks[ix].reg[offset >> 2];
+	}
+	scratch = 0;				// unmapped, reads as zero
+	return &scratch;
+}
+
+static uint64_t clock_ns(void) {
+	return virtual_clock ? virtual_ns : hal_host_nanos();
+}
+
+static uint64_t micros(void) {
+	return clock_ns() / 1000;
+}
+
+//----------------------------------------------------------------------
+//	SD card model
+//----------------------------------------------------------------------
+static void emmc_load(void) {
+	unsigned int lba = emmc.lba + emmc.done;
+	for(int ix = 0; ix < 128; ++ix) emmc.block[ix] = 0;	// past the end of the image
+	if(fseek(sd_image, (long)lba * 512, SEEK_SET) == 0)
+		if(fread(emmc.block, 1, 512, sd_image)) {}
+}
+
+static void emmc_store(void) {
+	unsigned int lba = emmc.lba + emmc.done;
+	if(fseek(sd_image, (long)lba * 512, SEEK_SET) == 0)
+		fwrite(emmc.block, 1, 512, sd_image);
+}
+
+static void emmc_command(unsigned int cmd) {
+	unsigned int index = (cmd >> 24) & 0x3F;
+	unsigned int arg = *reg(EMMC_ARG1);
+	int app = emmc.app;
+
+	emmc.app = 0;
+	if(!sd_image) {
+		*reg(EMMC_INTERRUPT) |= EMMC_INT_TIMEOUT;
+		return;
+	}
+	*reg(EMMC_RESP0) = 0x900;				// R1, transfer state
+	switch(index) {
+		case 3: *reg(EMMC_RESP0) = 0x12340500; break;	// RCA 0x1234
+		case 8: *reg(EMMC_RESP0) = arg & 0xFFF; break;
+		case 41: if(app) *reg(EMMC_RESP0) = 0xC0FF8000; break;	// ready, SDHC
+		case 55: emmc.app = 1; *reg(EMMC_RESP0) = 0x120; break;
+		case 17: case 18: case 24: case 25:
+			emmc.lba = arg;
+			emmc.blocks = (cmd & 0x20) ? *reg(EMMC_BLKSIZECNT) >> 16 : 1;
+			emmc.done = 0;
+			emmc.word = 0;
+			if(index < 24) {
+				emmc.state = EMMC_READ;
+				emmc_load();
+				*reg(EMMC_INTERRUPT) |= EMMC_INT_READ_RDY;
+			} else {
+				emmc.state = EMMC_WRITE;
+				*reg(EMMC_INTERRUPT) |= EMMC_INT_WRITE_RDY;
+			}
+			break;
+	}
+	*reg(EMMC_INTERRUPT) |= EMMC_INT_CMD_DONE;
+}
+
+static unsigned int emmc_data_read(void) {
+	if(emmc.state != EMMC_READ) return 0;
+	unsigned int val = emmc.block[emmc.word++];
+	if(emmc.word < 128) return val;
+	emmc.word = 0;
+	if(++emmc.done < emmc.blocks) {
+		emmc_load();
+		*reg(EMMC_INTERRUPT) |= EMMC_INT_READ_RDY;
+	} else {
+		emmc.state = EMMC_IDLE;
+		*reg(EMMC_INTERRUPT) |= EMMC_INT_DATA_DONE;
+	}
+	return val;
+}
+
+static void emmc_data_write(unsigned int val) {
+	if(emmc.state != EMMC_WRITE) return;
+	emmc.block[emmc.word++] = val;
+	if(emmc.word < 128) return;
+	emmc_store();
+	emmc.word = 0;
+	if(++emmc.done < emmc.blocks) {
+		*reg(EMMC_INTERRUPT) |= EMMC_INT_WRITE_RDY;
+		return;
+	}
+	unsigned int busy = SD_BUSY_US + emmc.blocks * SD_BLOCK_US;
+	if(++emmc.writes % SD_STALL_EVERY == 0) busy += SD_STALL_US;
+	emmc.busy_until = micros() + busy;
+	emmc.state = EMMC_PROGRAM;
+}
+
+static void emmc_poll(void) {
+	if(emmc.state != EMMC_PROGRAM) return;
+	if(micros() >= emmc.busy_until) {
+		emmc.state = EMMC_IDLE;
+		*reg(EMMC_INTERRUPT) |= EMMC_INT_DATA_DONE;
+	} else if(virtual_clock) {
+		hal_host_clock_advance(1);
+	}
+}
+
+static void emmc_control1(unsigned int val) {
+	if(val & 0x05000000) {			// SRST_HC or SRST_DATA
+		emmc.state = EMMC_IDLE;
+		emmc.app = 0;
+	}
+	val &= ~0x07000000;				// resets complete at once
+	if(val & 0x1) val |= 0x2;		// the clock is stable as soon as enabled
+	*reg(EMMC_CONTROL1) = val;
+}
+
+//----------------------------------------------------------------------
+//	SPI device model
+//----------------------------------------------------------------------
+static unsigned char spi_shift(void) {
+	uint32_t level = *reg(GPLEV0);
+	unsigned int ix = spi_index++;
+	unsigned int val;
+
+	if(!(level & (1 << 7))) {			// CE1 - mic one, msb first
+		val = spi_sample[HAL_SPI_MIC_ONE];
+		return ix == 0 ? (val >> 8) & 0xFF : val & 0xFF;
+	}
+	if(!(level & (1 << 8))) {			// CE0 - mic two, msb first
+		val = spi_sample[HAL_SPI_MIC_TWO];
+		return ix == 0 ? (val >> 8) & 0xFF : val & 0xFF;
+	}
+	if(!(level & (1 << 25))) {			// MAX187, 12 bits after a null bit
+		val = spi_sample[HAL_SPI_CUFF] & 0xFFF;
+		return ix == 0 ? (val >> 5) & 0x7F : (val << 3) & 0xF8;
+	}
+	return 0xFF;
+}
+
+static void spi_write(unsigned int addr, unsigned int val) {
+	if(addr == SPI_FIFO) {
+		unsigned int bytes = 1;
+		if(*reg(SPI_CS) & 0x100) {			// DMAEN, packed words
+			bytes = spi_dlen < 4 ? spi_dlen : 4;
+			spi_dlen -= bytes;
+		}
+		while(bytes--) {
+			unsigned char out = spi_shift();
+			if(spi_rx_head - spi_rx_tail < SPI_RX_QUEUE)
+				spi_rx[spi_rx_head++ % SPI_RX_QUEUE] = out;
+		}
+		return;
+	}
+	if(addr == SPI_CS && (val & 0x30)) {	// CLEAR TX/RX fifo
+		spi_index = 0;
+		spi_rx_head = spi_rx_tail = 0;
+		spi_dlen = *reg(SPI_DLEN);
+	}
+	*reg(addr) = val;
+}
+
+static unsigned int spi_read(unsigned int addr) {
+	if(addr == SPI_FIFO) {
+		unsigned int word = 0, shift = 0;
+		unsigned int bytes = (*reg(SPI_CS) & 0x100) ? 4 : 1;
+		while(bytes-- && spi_rx_head != spi_rx_tail) {
+			word |= spi_rx[spi_rx_tail++ % SPI_RX_QUEUE] << shift;
+			shift += 8;
+		}
+		return word;
+	}
+	uint32_t cs = *reg(SPI_CS) | 0x00050000;	// TXD and DONE
+	if(spi_rx_head != spi_rx_tail) cs |= 0x00020000;	// RXD
+	return cs;
+}
+
+//----------------------------------------------------------------------
+//	mini UART transmit FIFO, 10 bit times per byte
+//----------------------------------------------------------------------
+static void uart_drain(void) {
+	uint64_t now = clock_ns();
+	uint64_t baud = 250000000 / (8 * ((uint64_t)*reg(AUX_MU_BAUD_REG) + 1));
+	uint64_t bytes = (now - uart_tx_drained) * baud / 10000000000ull;
+
+	if(bytes >= uart_tx_level) {
+		uart_tx_level = 0;
+		uart_tx_drained = now;
+	}
+	else if(bytes) {
+		uart_tx_level -= bytes;
+		uart_tx_drained += bytes * 10000000000ull / baud;
+	}
+}
+
+static int uart_rx_ready(void) {
+	return uart_rx_head != uart_rx_tail;
+}
+
+static unsigned int uart_lsr(void) {
+	uart_drain();
+	return (uart_tx_level < 8 ? 0x20 : 0) | (uart_tx_level == 0 ? 0x40 : 0) |
+		uart_rx_ready();
+}
+
+static unsigned int uart_pending(void) {
+	unsigned int ier = *reg(AUX_MU_IER_REG);
+	return ((ier & 1) && uart_rx_ready()) || ((ier & 2) && (uart_lsr() & 0x20));
+}
+
+//----------------------------------------------------------------------
+//	VC bus address map and DMA engine
+//----------------------------------------------------------------------
+#define BUS_REGIONS 16
+
+static struct {
+	volatile char* base;
+	unsigned int size;
+	unsigned int bus;
+} bus_map[BUS_REGIONS];
+static unsigned int bus_regions = 0;
+static unsigned int bus_next = 0x40000000;
+
+unsigned int hal_bus_addr(const volatile void* ptr, unsigned int size) {
+	volatile char* p = (volatile char*)ptr;
+	for(unsigned int ix = 0; ix < bus_regions; ++ix) {
+		if(p >= bus_map[ix].base && p + size <= bus_map[ix].base + bus_map[ix].size)
+			return bus_map[ix].bus + (unsigned int)(p - bus_map[ix].base);
+	}
+	if(bus_regions == BUS_REGIONS) return 0;
+	bus_map[bus_regions].base = p;
+	bus_map[bus_regions].size = size;
+	bus_map[bus_regions].bus = bus_next;
+	bus_next += (size + 31) & ~31;
+	return bus_map[bus_regions++].bus;
+}
+
+static volatile uint32_t* bus_ptr(unsigned int bus) {
+	for(unsigned int ix = 0; ix < bus_regions; ++ix) {
+		unsigned int offset = bus - bus_map[ix].bus;
+		if(offset + 4 <= bus_map[ix].size)
+			return (volatile uint32_t*)(bus_map[ix].base + offset);
+	}
+	return 0;
+}
+
+static int bus_peripheral(unsigned int bus) {
+	return (bus & 0xFF000000) == 0x7E000000;
+}
+
+static int bus_read(unsigned int bus, uint32_t* val) {
+	if(bus_peripheral(bus)) {
+		*val = GET32(bus - 0x7E000000 + 0x20000000);
+		return 1;
+	}
+	volatile uint32_t* p = bus_ptr(bus);
+	if(p) *val = *p;
+	return p != 0;
+}
+
+static int bus_write(unsigned int bus, uint32_t val) {
+	if(bus_peripheral(bus)) {
+		PUT32(bus - 0x7E000000 + 0x20000000, val);
+		return 1;
+	}
+	volatile uint32_t* p = bus_ptr(bus);
+	if(p) *p = val;
+	return p != 0;
+}
+
+static void dma_cs_write(unsigned int addr, unsigned int val) {
+	uint32_t* cs = reg(addr);
+	if(val & DMA_CS_RESET) {
+		*cs = 0;
+		*reg(addr - DMA_CS + DMA_CONBLK_AD) = 0;
+		return;
+	}
+	*cs &= ~(val & (DMA_CS_END | DMA_CS_INT));
+	*cs = (*cs & ~DMA_CS_ACTIVE) | (val & DMA_CS_ACTIVE);
+}
+
+static void dma_channel_run(unsigned int channel) {
+	uint32_t* cs = reg(DMA_CHAN(channel) + DMA_CS);
+	uint32_t* conblk = reg(DMA_CHAN(channel) + DMA_CONBLK_AD);
+
+	while(*conblk) {
+		volatile uint32_t* cb = bus_ptr(*conblk);
+		if(!cb) break;
+		unsigned int ti = cb[0], src = cb[1], dst = cb[2], len = cb[3];
+
+		for(unsigned int offset = 0; offset < len; offset += 4) {
+			uint32_t word = 0;
+			if(!bus_read(src + ((ti & DMA_TI_SRC_INC) ? offset : 0), &word) ||
+				!bus_write(dst + ((ti & DMA_TI_DEST_INC) ? offset : 0), word)) {
+				*cs |= DMA_CS_ERROR;
+				break;
+			}
+		}
+		if(ti & DMA_TI_INTEN) {
+			*cs |= DMA_CS_INT;
+			*reg(DMA_INT_STATUS) |= 1 << channel;
+		}
+		if(*cs & DMA_CS_ERROR) break;
+		*conblk = cb[5];
+	}
+	*conblk = 0;
+	*cs = (*cs & ~DMA_CS_ACTIVE) | DMA_CS_END;
+}
+
+//----------------------------------------------------------------------
+//	register accessors
+//----------------------------------------------------------------------
+static int dma_cs_reg(unsigned int addr) {
+	return addr >= DMA_CHAN(0) && addr < DMA_CHAN(15) && (addr & 0xFF) == DMA_CS;
+}
+
+void PUT32(unsigned int addr, unsigned int val) {
+	if(dma_cs_reg(addr)) {
+		dma_cs_write(addr, val);
+		return;
+	}
+	switch(addr) {
+		case CS:
+			*reg(CS) &= ~(val & 0xF);
+			break;
+		case GPSET0:
+			*reg(GPLEV0) |= val;
+			break;
+		case GPCLR0:
+			*reg(GPLEV0) &= ~val;
+			break;
+		case SPI_CS:
+		case SPI_FIFO:
+			spi_write(addr, val);
+			break;
+		case EMMC_CMDTM:
+			*reg(EMMC_CMDTM) = val;
+			emmc_command(val);
+			break;
+		case EMMC_DATA:
+			emmc_data_write(val);
+			break;
+		case EMMC_INTERRUPT:
+			*reg(EMMC_INTERRUPT) &= ~val;
+			break;
+		case EMMC_CONTROL1:
+			emmc_control1(val);
+			break;
+		case AUX_MU_IO_REG:
+			uart_drain();
+			if(uart_tx_level == 0) uart_tx_drained = clock_ns();
+			if(uart_tx_level < 8) {
+				++uart_tx_level;
+				++uart_tx_count;
+				if(uart_sink) uart_sink(val);
+			}
+			break;
+		default:
+			*reg(addr) = val;
+	}
+}
+
+unsigned int GET32(unsigned int addr) {
+	switch(addr) {
+		case CLO:
+			return (uint32_t)micros();
+		case CHI:
+			return (uint32_t)(micros() >> 32);
+		case IRQ_PEND1:
+			return *reg(IRQ_PEND1) | (*reg(CS) & 0xF) | (uart_pending() << 29);
+		case SPI_CS:
+		case SPI_FIFO:
+			return spi_read(addr);
+		case AUX_MU_IO_REG:
+			if(uart_rx_head == uart_rx_tail) return 0;
+			return uart_rx[uart_rx_tail++ % UART_RX_QUEUE];
+		case AUX_MU_LSR_REG:
+			return uart_lsr();
+		case AUX_MU_STAT_REG:
+			return ((uart_lsr() & 0x20) ? 0x2 : 0) | uart_rx_ready();
+		case EMMC_DATA:
+			return emmc_data_read();
+		case EMMC_INTERRUPT:
+			emmc_poll();
+			return *reg(EMMC_INTERRUPT);
+		case EMMC_STATUS:
+			emmc_poll();
+			return emmc.state != EMMC_IDLE ? 0x2 : 0;	// DAT_INHIBIT
+		default:
+			return *reg(addr);
+	}
+}
+
+void PUT16(unsigned int addr, unsigned int val) {
+	PUT32(addr, val & 0xFFFF);
+}
+
+unsigned int GET16(unsigned int addr) {
+	return GET32(addr) & 0xFFFF;
+}
+
+void PUT8(unsigned int addr, unsigned char val) {
+	PUT32(addr, val);
+}
+
+unsigned char GET8(unsigned int addr) {
+	return GET32(addr) & 0xFF;
+}
+
+void dummy(unsigned int ra) {
+	(void)ra;
+}
+
+void enable_irq(void) {
+}
+
+void disable_irq(void) {
+}
+
+//----------------------------------------------------------------------
+//	mock control
+//----------------------------------------------------------------------
+void hal_host_reset(void) {
+	for(unsigned int ix = 0; ix < NUM_BANKS; ++ix)
+		for(unsigned int jx = 0; jx < BANK_WORDS; ++jx)
+			banks[ix].reg[jx] = 0;
+	*reg(GPLEV0) = 0xFFFFFFFF;		// pulled up, chip selects idle
+	spi_index = 0;
+	spi_rx_head = spi_rx_tail = 0;
+	uart_rx_head = uart_rx_tail = 0;
+	uart_tx_count = 0;
+	uart_tx_level = 0;
+	spi_dlen = 0;
+	emmc.state = EMMC_IDLE;
+	emmc.app = 0;
+	emmc.writes = 0;
+}
+
+void hal_host_spi_sample(unsigned int device, unsigned int value) {
+	if(device < HAL_SPI_DEVICES)
+		spi_sample[device] = value;
+}
+
+void hal_host_timer_match(unsigned int channel) {
+	*reg(CS) |= 1 << channel;
+}
+
+unsigned int hal_host_uart_tx_count(void) {
+	return uart_tx_count;
+}
+
+void hal_host_uart_rx(unsigned char c) {
+	if(uart_rx_head - uart_rx_tail < UART_RX_QUEUE)
+		uart_rx[uart_rx_head++ % UART_RX_QUEUE] = c;
+}
+
+void hal_host_gpio_level(unsigned int pin, unsigned int state) {
+	if(state) *reg(GPLEV0) |= 1 << pin;
+	else *reg(GPLEV0) &= ~(1 << pin);
+}
+
+unsigned long long hal_host_nanos(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+unsigned int hal_cycles(void) {
+	return (unsigned int)hal_host_nanos();
+}
+
+void hal_host_dma_run(void) {
+	for(unsigned int channel = 0; channel < 15; ++channel)
+		if(*reg(DMA_CHAN(channel) + DMA_CS) & DMA_CS_ACTIVE)
+			dma_channel_run(channel);
+}
+
+void hal_host_clock_advance(unsigned int us) {
+	if(!virtual_clock) {
+		virtual_ns = hal_host_nanos();
+		uart_tx_drained = virtual_ns;
+		virtual_clock = 1;
+	}
+	uint32_t before = (uint32_t)micros();
+	virtual_ns += (uint64_t)us * 1000;
+	uint32_t passed = (uint32_t)micros() - before;
+
+	for(unsigned int channel = 0; channel < 4; ++channel) {
+		uint32_t compare = *reg(C0 + 4 * channel);
+		if(compare - before - 1 < passed) *reg(CS) |= 1 << channel;
+	}
+}
+
+void hal_host_uart_sink(void (*sink)(unsigned char)) {
+	uart_sink = sink;
+}
+
+// the SD card image, created if missing, returns 0 or -1
+int hal_host_sd_image(const char* path) {
+	if(sd_image) fclose(sd_image);
+	sd_image = fopen(path, "r+b");
+	if(!sd_image) sd_image = fopen(path, "w+b");
+	return sd_image ? 0 : -1;
+}
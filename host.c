@@ -0,0 +1,249 @@
+/**********************************************************************/
+//	host.c   October 17, 2026
+/***********************************************************************
+	Host harness for the firmware core. Brings the system up against
+	the mock register banks in hal_host.c and runs it on the mock's
+	virtual clock in STEP_US steps. The C1 and C3 compares fire as CLO
+	passes them, and each C1 match feeds synthetic microphone and cuff
+	samples through the SPI device model, waits a pseudo random
+	interrupt latency of up to LATENCY_US and calls fiq_service_routine,
+	timing the call with CLOCK_MONOTONIC. The simulated DMA engine is
+	run after each tick, so its work is not charged to the ISR, and the
+	foreground tasks then run until sched_run() is idle, as the _main_
+	loop would. The C3 and UART interrupts are served in whichever step
+	they come up.
+
+	The deadline report shows the latency as jitter while the tick rate
+	stays exact. With a telemetry file telemetry is turned on, and the
+	frames come out at the configured baud rate as the board would send
+	them. bpsure_teledec reads the file back.
+
+	With an SD card image the run is logged as one session through the
+	EMMC model. A new image gets an MBR with a log partition of
+	SD_IMAGE_BLOCKS first, and sessions accumulate in it from run to
+	run. The log is remounted at the end to check its append point, and
+	bpsure_replay reads the last session back.
+
+	usage: bpsure_host [ticks] [telemetry.bin|-] [sdcard.img]
+***********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "hal.h"
+#include "kernel.h"
+#include "acquire.h"
+#include "telemetry.h"
+#include "profile.h"
+#include "peripheral.h"
+#include "uart.h"
+#include "sdlog.h"
+#include "sdcard.h"
+#include "math.h"
+
+#define TICK_PERIOD_US	1250		// C1 deadlines, see kernel.c
+#define STEP_US			5
+#define LATENCY_US		40
+#define SD_IMAGE_FIRST	2048		// log partition, LBA
+#define SD_IMAGE_BLOCKS	65536		// 32MB
+
+static FILE* telemetry_file = 0;
+
+static void telemetry_byte(unsigned char c) {
+	fputc(c, telemetry_file);
+}
+
+//----------------------------------------------------------------------
+// synthetic signal, a 1.2Hz pulse on both mics plus noise,
+// and a cuff deflating from 180mmHg
+//----------------------------------------------------------------------
+static void load_samples(unsigned int tick) {
+	static uint32_t seed = 12345;
+	int16_t phase = (int16_t)(tick * 98);	// ~1.2Hz at 800 ticks/s in BAM
+	int pulse = isin(phase) >> 4;
+
+	seed = seed * 1103515245 + 12345;
+	int noise = (int)((seed >> 16) & 0xFF) - 128;
+
+	hal_host_spi_sample(HAL_SPI_MIC_ONE, (uint16_t)(pulse + noise));
+	hal_host_spi_sample(HAL_SPI_MIC_TWO, (uint16_t)(pulse - noise / 2));
+	hal_host_spi_sample(HAL_SPI_CUFF, 445 + 2430 - (tick / 40) % 2430);
+}
+
+// an MBR with the one log partition, on an image that has none yet
+static int sd_prepare(const char* path) {
+	unsigned char mbr[SD_BLOCK] = { 0 };
+	FILE* f = fopen(path, "rb");
+	int blank = !f || fread(mbr, 1, SD_BLOCK, f) < SD_BLOCK || mbr[510] != 0x55;
+	if(f) fclose(f);
+
+	if(blank) {
+		unsigned char* entry = mbr + 446;
+		for(int ix = 0; ix < SD_BLOCK; ++ix) mbr[ix] = 0;
+		entry[4] = SDLOG_PARTITION;
+		for(int ix = 0; ix < 4; ++ix) {
+			entry[8 + ix] = (SD_IMAGE_FIRST >> (8 * ix)) & 0xFF;
+			entry[12 + ix] = (SD_IMAGE_BLOCKS >> (8 * ix)) & 0xFF;
+		}
+		mbr[510] = 0x55;
+		mbr[511] = 0xAA;
+		f = fopen(path, "wb");
+		if(!f || fwrite(mbr, 1, SD_BLOCK, f) != SD_BLOCK) return -1;
+		fclose(f);
+	}
+	return hal_host_sd_image(path);
+}
+
+//----------------------------------------------------------------------
+int main(int argc, char** argv) {
+	unsigned int ticks = argc > 1 ? (unsigned int)atoi(argv[1]) : 100000;
+	uint64_t total = 0, worst = 0, best = ~(uint64_t)0;
+	uint64_t foreground_worst = 0;
+
+	hal_host_reset();
+	hal_host_clock_advance(0);			//virtual clock from here on
+	if(argc > 3 && sd_prepare(argv[3])) {
+		perror(argv[3]);
+		return 1;
+	}
+	system_init();
+	if(argc > 3 && sdlog_start()) {
+		fprintf(stderr, "%s: no log to start, state %d\n", argv[3], sdlog_state());
+		return 1;
+	}
+
+	if(argc > 2 && !(argv[2][0] == '-' && argv[2][1] == '\0')) {
+		telemetry_file = fopen(argv[2], "wb");
+		if(!telemetry_file) {
+			perror(argv[2]);
+			return 1;
+		}
+		hal_host_uart_sink(telemetry_byte);
+		telemetry_enable(1);
+	}
+
+	uint32_t seed = 99;
+	uint32_t first_deadline = 0, last_deadline = 0;
+	for(unsigned int tick = 0; tick < ticks; ) {
+		hal_host_clock_advance(STEP_US);
+		unsigned int pending = GET32(IRQ_PEND1);
+		if(!(pending & TIMER_IRQ(&tick_job))) {
+			if(pending) {					//C3 or the UART
+				irq_service_routine();
+				while(sched_run(&sched) >= 0) continue;
+			}
+			continue;
+		}
+
+		if(tick == 0) first_deadline = tick_job.deadline;
+		last_deadline = tick_job.deadline;
+		load_samples(tick);
+		seed = seed * 1103515245 + 12345;
+		hal_host_clock_advance((seed >> 16) % (LATENCY_US + 1));
+
+		uint64_t start = hal_host_nanos();
+		fiq_service_routine();
+		uint64_t elapsed = hal_host_nanos() - start;
+		if(pending & ~TIMER_IRQ(&tick_job)) irq_service_routine();
+
+		hal_host_dma_run();		//the DMA engine runs between ticks
+
+		start = hal_host_nanos();		//foreground work before the next tick
+		while(sched_run(&sched) >= 0) continue;
+		uint64_t foreground = hal_host_nanos() - start;
+		if(foreground > foreground_worst) foreground_worst = foreground;
+
+		++tick;
+		total += elapsed;
+		if(elapsed > worst) worst = elapsed;
+		if(elapsed < best) best = elapsed;
+	}
+
+	if(argc > 3) {						//flush the session
+		sdlog_stop();
+		while(sdlog_active()) {
+			hal_host_clock_advance(STEP_US);
+			sdlog_service();
+		}
+	}
+
+	if(ticks == 0) return 0;
+	double avg = (double)total / ticks;
+	printf("fiq_service_routine: %u ticks\n", ticks);
+	printf("  per tick   min %llu ns  avg %.1f ns  max %llu ns\n",
+		(unsigned long long)best, avg, (unsigned long long)worst);
+	printf("  throughput %.0f ticks/s\n", 1e9 / avg);
+	printf("  budget     avg %.3f%%  max %.3f%% of %u us\n",
+		avg / (TICK_PERIOD_US * 10.0), worst / (TICK_PERIOD_US * 10.0),
+		TICK_PERIOD_US);
+#ifndef ACQUIRE_PIO
+	printf("  acquisition DMA, %u overruns\n", acquire_overruns());
+#else
+	printf("  acquisition polled SPI\n");
+#endif
+	for(int ix = 0; ix < 2; ++ix) {
+		TimerJob* job = ix ? &display_job : &tick_job;
+		TimerStats st;
+		timer_read(&job->stats, &st);
+		printf("%s C%u every %u us, %u deadlines  %u missed\n",
+			ix ? "display" : "tick", job->channel, job->period_us, st.count, st.missed);
+		printf("  late min %u us  avg %.1f us  max %u us\n", st.late_min,
+			st.count ? (double)st.late_total / st.count : 0.0, st.late_max);
+		if(ix) continue;
+		timer_read(&capture_stats, &st);
+		printf("  sample in hand min %u us  avg %.1f us  max %u us after the deadline\n",
+			st.late_min, st.count ? (double)st.late_total / st.count : 0.0, st.late_max);
+	}
+	if(ticks > 1)
+		printf("tick rate %.4f Hz over %u ticks of the virtual clock\n",
+			(ticks - 1) * 1e6 / (last_deadline - first_deadline), ticks);
+	printf("pipeline, busiest tick runs %d stages\n",
+		pipeline_busiest(&pipeline, 3200));
+	for(int ix = 0; ix < pipeline.stages; ++ix)
+		printf("  %-10s every %3u ticks, phase %u\n", pipeline.stage[ix].name,
+			pipeline.stage[ix].divider, pipeline.stage[ix].phase);
+	printf("foreground, max %llu ns after a tick, %u ticks and %u blocks overrun\n",
+		(unsigned long long)foreground_worst, timing.tick_overruns,
+		timing.block_overruns);
+	printf("  task       pri    runs   posts missed  latency avg/max us  run avg/max ns\n");
+	for(int ix = 0; ix < sched.tasks; ++ix) {
+		TaskStats st;
+		sched_read(&sched, ix, &st);
+		printf("  %-10s %3d %7u %7u %6u %9.1f %8u %9.1f %8u\n",
+			sched.task[ix].name, sched.task[ix].priority, st.runs, st.posts,
+			st.missed, st.runs ? (double)st.latency_total / st.runs : 0.0,
+			st.latency_max, st.runs ? (double)st.runtime_total / st.runs : 0.0,
+			st.runtime_max);
+	}
+#ifdef PROFILE
+	printf("isr stages (ns)   count      min      avg      max\n");
+	for(int stage = 0; stage < PROFILE_STAGES; ++stage) {
+		ProfileStat s;
+		if(!profile_read(stage, &s)) continue;
+		printf("  %-12s %9u %8u %8.1f %8u\n", profile_name(stage), s.count,
+			s.min, (double)s.total / s.count, s.max);
+	}
+#endif
+	if(argc > 3) {
+		const SdLogStats* ls = &sdlog_stats;
+		unsigned int session = sdlog_session();
+		printf("sd log session %u, %u records in %u blocks, %u lost, %u errors\n",
+			session, ls->records, ls->blocks, ls->lost, ls->errors);
+		printf("  %u transfers  write avg %.0f us  max %u us\n", ls->transfers,
+			ls->transfers ? (double)ls->busy_total_us / ls->transfers : 0.0,
+			ls->latency_max_us);
+		printf("  sustained %.1f KB/s while writing, %.1f KB/s logged\n",
+			ls->busy_total_us ? ls->blocks * 512.0 * 1000 / ls->busy_total_us : 0.0,
+			ls->blocks * 512.0 * 1000 / (GET32(CLO) - ls->start_us));
+		int mounted = sdlog_mount();
+		printf("  remounted: %s, next session %u\n",
+			mounted || sdlog_session() != session ? "FAIL" : "ok", sdlog_session() + 1);
+	}
+	if(telemetry_file) {
+		printf("telemetry\n");
+		printf("  %u frames sent  %u dropped  %u UART bytes\n",
+			telemetry_stats.sent, telemetry_stats.dropped,
+			hal_host_uart_tx_count());
+		fclose(telemetry_file);
+	}
+	return 0;
+}
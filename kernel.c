@@ -33,16 +33,25 @@
 #include <stdint.h>
 #include "math.h"
 #include "library.h"
+#include "fixed.h"
+#include "bp.h"
+#include "biquad.h"
+#include "nlms.h"
+#include "pipeline.h"
+#include "timer.h"
+#include "sched.h"
+#include "sdlog.h"
+#include "ring.h"
+#include "fft.h"
+#include "stats.h"
 #include "peripheral.h"
 #include "OLED_display.h"
-
-extern void PUT8(unsigned int, unsigned char);
-extern unsigned char GET8(unsigned int);
-extern void PUT32(unsigned int, unsigned int);
-extern unsigned int GET32(unsigned int);
-extern void dummy(unsigned int);
-extern void disable_irq(void);
-extern void enable_irq(void);
+#include "kernel.h"
+#include "acquire.h"
+#include "uart.h"
+#include "telemetry.h"
+#include "profile.h"
+#include "hal.h"
 	
 // foreground text colors
 #define BLACK		"\x1b[0;30m"
@@ -55,11 +64,6 @@ extern void enable_irq(void);
 #define CYAN 		"\x1b[1;36m"
 #define WHITE		"\x1b[1;37m"
 
-#define COM_RX_Buffer_Size    1024
-#define COM_TX_Buffer_Size    1024 
-#define COM_TX_BUFFER_FULL  0x1F00
-#define COM_RX_BUFFER_EMPTY 0x1E00
-
 #define msb 1
 #define lsb 0
 
@@ -75,80 +79,45 @@ union mic_data {
 volatile union mic_data mic_one;
 volatile union mic_data mic_two;
 
+#ifdef FIXED_DSP
+RingBufferQ31	pulse_data;
+#else
+RingBuffer	pulse_data;
+#endif
+PulseInfo 	pulse;
+BpEngine	bp_engine;		// oscillometric estimate, fills pulse
+
 //----------------------------------------------------------------------
-//  COM UART buffers
+//	microphone band-pass, Korotkoff band with a mains hum notch. Build
+//	with MIC_RAW to feed the product unfiltered.
 //----------------------------------------------------------------------
-int  COM_RX_Contents = 0, COM_TX_Contents = 0;
-char COM_TX_Buffer[COM_TX_Buffer_Size];
-char COM_RX_Buffer[COM_RX_Buffer_Size];
+#define MIC_FILTER		BIQUAD_KOROTKOFF_60HZ
 
-char *Begin_COM_RX_Pointer = COM_RX_Buffer;
-char *End_COM_RX_Pointer = COM_RX_Buffer + COM_RX_Buffer_Size-1;
-char *Write_COM_RX_Pointer = COM_RX_Buffer;
-char *Read_COM_RX_Pointer = COM_RX_Buffer;
-
-char *Begin_COM_TX_Pointer = COM_TX_Buffer;
-char *End_COM_TX_Pointer = COM_TX_Buffer + COM_TX_Buffer_Size-1;
-char *Write_COM_TX_Pointer = COM_TX_Buffer;
-char *Read_COM_TX_Pointer = COM_TX_Buffer;
-
-RingBuffer	pulse_data;
-PulseInfo 	pulse;
+BiquadCascade	mic_filter;
+BiquadState		mic_filter_state[2];
 
 //----------------------------------------------------------------------
-//	UART System Initialization
-//----------------------------------------------------------------------
-void uart_init(void) {
-    unsigned int ra;
-    //alt function 5 for uart1
-	 gpioMODE(14, ALT5); //GPIO14 TXD
-	 gpioMODE(15, ALT5); //GPIO15 RXD
-
-    PUT32(AUX_ENABLES,1);
-    PUT32(AUX_MU_IER_REG,0);
-    PUT32(AUX_MU_CNTL_REG,0);
-    PUT32(AUX_MU_LCR_REG,3);
-    PUT32(AUX_MU_MCR_REG,0);
-	 PUT32(AUX_MU_IER_REG, 0);
-    PUT32(AUX_MU_IIR_REG,0xC6);
-    PUT32(AUX_MU_BAUD_REG,270);
- 
-    PUT32(GPPUD,0);
-    for(ra=0;ra<150;ra++) dummy(ra);
-    PUT32(GPPUDCLK0,(3<<14));
-    for(ra=0;ra<150;ra++) dummy(ra);
-    PUT32(GPPUDCLK0,0);
-    PUT32(AUX_MU_CNTL_REG,3);
-}
+//	adaptive noise canceller, mic_two as the noise reference for
+//	mic_one. Build with NOISE_CANCEL to run it after the filters, the
+//	product is then the cleaned mic_one against itself.
 //----------------------------------------------------------------------
-int uart_getc(void) {
-	int char_in;
-	if(Read_COM_RX_Pointer != Write_COM_RX_Pointer) {
-		char_in = *Read_COM_RX_Pointer;
-		if(++Read_COM_RX_Pointer > End_COM_RX_Pointer)
-			Read_COM_RX_Pointer = Begin_COM_RX_Pointer;
-	}
-	else char_in = COM_RX_BUFFER_EMPTY;
-	return char_in;
-}
+Nlms			canceller;
+
 //----------------------------------------------------------------------
-int uart_putc(int char_out) {
-	COM_TX_Contents = Write_COM_TX_Pointer - Read_COM_TX_Pointer;
-	if(COM_TX_Contents < 0)
-		COM_TX_Contents = COM_TX_Buffer_Size + COM_TX_Contents;    
-	if(COM_TX_Contents < (COM_TX_Buffer_Size - 1)) {        
-		*Write_COM_TX_Pointer = char_out;
-		if(++Write_COM_TX_Pointer > End_COM_TX_Pointer)
-			Write_COM_TX_Pointer = Begin_COM_TX_Pointer;
-		return RETURN_SUCCESS;
-	}
-	else return COM_TX_BUFFER_FULL;
-}
+//  z-score peak detection on the processed microphone signal
 //----------------------------------------------------------------------
-void uart_puts(char *s) {
-	while(*s)
-		uart_putc(*s++);
-}
+#define PULSE_LAG		32
+#define PULSE_THRESHOLD	3.5f
+#define PULSE_INFLUENCE	0.5f
+
+#ifdef FIXED_DSP
+ZScoreQ31		pulse_detector;
+#else
+ZScoreDetector	pulse_detector;
+#endif
+volatile int	pulse_signal = 0;
+volatile unsigned int pulse_count = 0;
+
 //----------------------------------------------------------------------
 //	SPI System Initialization
 //----------------------------------------------------------------------
@@ -202,17 +171,113 @@ int spi_microphones() {
    return 0;
 }
 
-float process_microphones() {
-	float mic_one_sig = (float)mic_one.word;
-	float mic_two_sig = (float)mic_two.word;
+float process_microphones(short one, short two) {
+	float mic_one_sig = (float)one;
+	float mic_two_sig = (float)two;
 	
 	float val = (mic_one_sig * mic_two_sig);
 	return val < 0 ? 0 : val;
 }
 
+q31_t process_microphones_q31(short one, short two) {
+	q31_t val = q15_mul_q31(one, two);
+	return val < 0 ? 0 : val;
+}
+
+//----------------------------------------------------------------------
+//	Per-tick signal path, microphone product through the ring buffer
+//	deviation and the peak detector. The signal task runs it on each
+//	tick the ISR acquired, bpsure_replay runs it on recordings.
+//----------------------------------------------------------------------
+void signal_init(void) {
+#ifdef FIXED_DSP
+	InitRingBufferQ31(&pulse_data);
+	InitZScoreQ31(&pulse_detector, PULSE_LAG, PULSE_THRESHOLD, PULSE_INFLUENCE);
+#else
+	InitRingBuffer(&pulse_data);
+	InitZScore(&pulse_detector, PULSE_LAG, PULSE_THRESHOLD, PULSE_INFLUENCE);
+#endif
+	biquad_preset(&mic_filter, MIC_FILTER, SAMPLE_HZ);
+	biquad_reset(&mic_filter_state[0]);
+	biquad_reset(&mic_filter_state[1]);
+	nlms_init(&canceller, CANCEL_TAPS, CANCEL_MU, CANCEL_EPS);
+	pulse_signal = 0;
+	pulse_count = 0;
+}
+
+#if !defined(FIXED_DSP) && (!defined(MIC_RAW) || defined(NOISE_CANCEL))
+static short to_sample(float y) {
+	y = max(min(y, Q15_MAX), Q15_MIN);
+	return (short)(y < 0 ? y - 0.5f : y + 0.5f);
+}
+#endif
+
+#if !defined(FIXED_DSP) && !defined(MIC_RAW)
+static short mic_filter_run(BiquadState* state, short x) {
+	return to_sample(biquad_run(&mic_filter, state, x));
+}
+#endif
+
+void signal_step(short one, short two, SignalOutput* out) {
+	PROFILE_START();
+#ifndef MIC_RAW
+#ifdef FIXED_DSP
+	one = biquad_run_q15(&mic_filter, &mic_filter_state[0], one);
+	two = biquad_run_q15(&mic_filter, &mic_filter_state[1], two);
+#else
+	one = mic_filter_run(&mic_filter_state[0], one);
+	two = mic_filter_run(&mic_filter_state[1], two);
+#endif
+	PROFILE_STAGE(PROFILE_FILTER);
+#endif
+#ifdef NOISE_CANCEL
+#ifdef FIXED_DSP
+	one = nlms_run_q15(&canceller, two, one);
+#else
+	one = to_sample(nlms_run(&canceller, two, one));
+#endif
+	two = one;
+	PROFILE_STAGE(PROFILE_CANCEL);
+#endif
+
+#ifdef FIXED_DSP
+	q31_t product = process_microphones_q31(one, two);
+	PROFILE_STAGE(PROFILE_PRODUCT);
+	WriteToRingBufferQ31(&pulse_data, product);
+	PROFILE_STAGE(PROFILE_RING);
+
+	int signal = ZScoreUpdateQ31(&pulse_detector, product);
+	PROFILE_STAGE(PROFILE_DETECT);
+	out->product = product >> 1;		//Q31 back to the raw product scale
+	out->deviation = DetermineDeviationQ31(&pulse_data) >> 1;
+	PROFILE_STAGE(PROFILE_DEVIATION);
+#else
+	int mic_val = (int)process_microphones(one, two);
+	PROFILE_STAGE(PROFILE_PRODUCT);
+	WriteToRingBuffer( &pulse_data, mic_val);
+	PROFILE_STAGE(PROFILE_RING);
+	
+	int signal = ZScoreUpdate(&pulse_detector, mic_val);
+	PROFILE_STAGE(PROFILE_DETECT);
+	out->product = mic_val;
+	out->deviation = DetermineDeviation(&pulse_data);
+	PROFILE_STAGE(PROFILE_DEVIATION);
+#endif
+	out->signal = signal;
+
+	if(pulse_signal > 0 && signal <= 0) ++pulse_count;	//end of a peak
+	pulse_signal = signal;
+}
+
 //----------------------------------------------------------------------
 //	get cuff pressure
 //----------------------------------------------------------------------
+int cuff_offset(int cuff_raw) {
+	cuff_raw -= 445;
+	if(cuff_raw < 0) cuff_raw = 0;
+	return cuff_raw;
+}
+
 int spi_cuff_pressure(void) {	
 	PUT32(SPI_CS, 0x000000B0);	//clear fifo registers & set TA=1	
 	gpioWR(25, LOW);				//CE2 chip enable
@@ -227,87 +292,335 @@ int spi_cuff_pressure(void) {
 	cuff_raw = (cuff_raw << 5) + (GET8(SPI_FIFO) >> 3);
 	PUT32(SPI_CS, 0x00000000);	//set TA=0
 	gpioWR(25, HIGH);				//CE2 chip disable
-	cuff_raw -= 445;
-	if(cuff_raw < 0) cuff_raw = 0;
-	return cuff_raw;
+	return cuff_offset(cuff_raw);
 }
 //----------------------------------------------------------------------
-// interrupt callback routine for the COM UART receive register
+//	Timer jobs on absolute deadlines, the sample tick on C1 and the
+//	display on C3
 //----------------------------------------------------------------------
-void UART_RX(void) {
-	*Write_COM_RX_Pointer = GET8(AUX_MU_IO_REG);
-	if(++Write_COM_RX_Pointer > End_COM_RX_Pointer)
-		Write_COM_RX_Pointer = Begin_COM_RX_Pointer;
+#define TICK_PERIOD_US		1250		// exactly SAMPLE_HZ
+#define DISPLAY_PERIOD_US	500000		// 2 Hz
+
+TimerJob	tick_job;
+TimerJob	display_job;
+volatile TimingStats timing;
+
+// "isr last 40 max 96 us overruns tick 0 block 0" over the UART
+static void timing_report(void) {
+	char line[96];
+
+	char* p = put_str(line, "isr last ");
+	p = put_uint(p, timing.isr_last_us);
+	p = put_str(p, " max ");
+	p = put_uint(p, timing.isr_max_us);
+	p = put_str(p, " us overruns tick ");
+	p = put_uint(p, timing.tick_overruns);
+	p = put_str(p, " block ");
+	p = put_uint(p, timing.block_overruns);
+	p = put_str(p, "\r\n");
+	uart_put_line(line, p);
 }
+
 //----------------------------------------------------------------------
-// interrupt callback routine for the COM UART transmit register
+//	Tick queue. The ISR appends each tick's raw samples, the signal
+//	task fills in the signal path results and the telemetry task sends
+//	them. The indices are free running and masked on use as in uart.c,
+//	each written by its own side only.
 //----------------------------------------------------------------------
-void UART_TX(void) {
-	if(Read_COM_TX_Pointer != Write_COM_TX_Pointer) {
-		PUT8(AUX_MU_IO_REG, *Read_COM_TX_Pointer);
-		if(++Read_COM_TX_Pointer > End_COM_TX_Pointer)
-			Read_COM_TX_Pointer = Begin_COM_TX_Pointer;
-	}
+#define TICK_QUEUE_SIZE		64			// power of two, 80 ms of ticks
+#define TICK_QUEUE_MASK		(TICK_QUEUE_SIZE - 1)
+
+#define barrier() __asm__ __volatile__("" ::: "memory")
+
+static TelemetrySample	tick_queue[TICK_QUEUE_SIZE];
+static volatile unsigned int tick_head = 0;			//ISR
+static volatile unsigned int tick_processed = 0;	//signal task
+static volatile unsigned int tick_sent = 0;			//telemetry task
+
+// envelope blocks, from the signal task to the pressure task
+#define BLOCK_QUEUE_SIZE	8
+#define BLOCK_QUEUE_MASK	(BLOCK_QUEUE_SIZE - 1)
+
+typedef struct {
+	int cuff;
+	int envelope;
+} EnvelopeBlock;
+
+static EnvelopeBlock	block_queue[BLOCK_QUEUE_SIZE];
+static unsigned int		block_head = 0, block_tail = 0;
+
+// raw microphone history for the spectra, written by the signal task
+#define SPECTRUM_LOG2		8			// 256 points, 3.125 Hz bins
+#define SPECTRUM_POINTS		(1 << SPECTRUM_LOG2)
+#define SPECTRUM_BINS		(SPECTRUM_POINTS / 2 + 1)
+#define SPECTRUM_HOP		(SPECTRUM_POINTS / 2)	// ticks, half overlapped
+
+static int16_t			mic_history[2][SPECTRUM_POINTS];
+static Ring				mic_ring[2];
+static unsigned int		spectrum_countdown = SPECTRUM_HOP;
+
+//----------------------------------------------------------------------
+//	Slower acquisition stages, run by the pipeline on ticks of their
+//	own
+//----------------------------------------------------------------------
+Pipeline	pipeline;
+int			cuff_stage;
+
+static void stage_button(void) {		//latching push button
+	static uint8_t SR1 = 0;
+	SR1 = (SR1 << 1) | !gpioRD(17);
+	if(SR1 == 0x80) SW1 ^= 1;
+}
+
+#ifdef ACQUIRE_PIO
+static void stage_cuff(void) {
+	cuff_val_processed = spi_cuff_pressure()*10 / 135;
+}
+#else
+#define stage_cuff	0					// acquire_flip() polls pipeline_due()
+#endif
+
+void pipeline_setup(void) {
+	pipeline_init(&pipeline);
+	pipeline_add(&pipeline, "button", 32, stage_button, PROFILE_BUTTON);
+	cuff_stage = pipeline_add(&pipeline, "cuff", 80, stage_cuff, PROFILE_CUFF);
 }
 
 //----------------------------------------------------------------------
-void irq_service_routine(void) {
-    unsigned int irq_pending1;
-    static unsigned int push_button = 0;
-    static unsigned int OLED_display = 0;
-    static unsigned int cuff_pressure = 0;
-    
-    static char cuff_buff[20];
-    cuff_buff[19] = '\0';
+//	Foreground tasks, dispatched by sched_run() in the _main_ loop. The
+//	blood pressure engine works on the window deviation decimated to
+//	its peak over every ENVELOPE_DECIMATE ticks.
+//----------------------------------------------------------------------
+Scheduler	sched;
+Decimator	envelope;
+static SignalOutput	signal_out;		// the latest tick's signal path results
+static int	signal_id, pressure_id, telemetry_id, display_id, log_id, spectrum_id;
 
-    irq_pending1=GET32(IRQ_PEND1);
-	 if(irq_pending1&2) {		
-		PUT32(C1,(GET32(CLO) + 0x000004E1)); 	//increment the counter
-		PUT32(CS,2);  					  	//clear the timer interrupt
-		
-		if(!(push_button++ % 32)) { 	//latching push button
-			static uint8_t SR1 = 0;
-			SR1 = (SR1 << 1) | !gpioRD(17);
-			if(SR1 == 0x80) SW1 ^= 1;
+static FftComplex	spectrum_work[SPECTRUM_POINTS / 2];
+static uint32_t		spectrum[2][SPECTRUM_BINS];	// magnitudes, mic_one and mic_two
+static WindowStats		mic_level[2];				// over the same window
+
+static void signal_task(void) {
+	while(tick_processed != tick_head) {
+		TelemetrySample* t = &tick_queue[tick_processed & TICK_QUEUE_MASK];
+
+		signal_step(t->mic_one, t->mic_two, &signal_out);
+		RING_PUSH(&mic_ring[0], int16_t, t->mic_one);
+		RING_PUSH(&mic_ring[1], int16_t, t->mic_two);
+		if(--spectrum_countdown == 0) {
+			spectrum_countdown = SPECTRUM_HOP;
+			sched_post(&sched, spectrum_id);
+		}
+		t->product = signal_out.product;
+		t->deviation = signal_out.deviation > 0xFFFF ? 0xFFFF : signal_out.deviation;
+		t->signal = signal_out.signal;
+
+		if(decimator_push(&envelope, signal_out.deviation)) {
+			if(block_head - block_tail < BLOCK_QUEUE_SIZE) {
+				EnvelopeBlock* b = &block_queue[block_head++ & BLOCK_QUEUE_MASK];
+				b->cuff = t->cuff;
+				b->envelope = envelope.out;
+				sched_post(&sched, pressure_id);
+			} else {
+				timing.block_overruns++;
+			}
 		}
+		barrier();
+		tick_processed++;
+	}
+	sched_post(&sched, telemetry_id);
+}
+
+static void pressure_task(void) {
+	PROFILE_START();
+	while(block_tail != block_head) {
+		const EnvelopeBlock* b = &block_queue[block_tail++ & BLOCK_QUEUE_MASK];
+		if(bp_update(&bp_engine, b->cuff, b->envelope) == BP_DONE)
+			bp_result(&bp_engine, &pulse);
+		PROFILE_STAGE(PROFILE_PRESSURE);
+	}
+}
+
+static void telemetry_task(void) {		//frees the slots either way
+	PROFILE_START();
+	while(tick_sent != tick_processed) {
+		const TelemetrySample* t = &tick_queue[tick_sent & TICK_QUEUE_MASK];
+		telemetry_sample(t);
+		sdlog_append(t);
+		barrier();
+		tick_sent++;
+		PROFILE_STAGE(PROFILE_TELEMETRY);
+	}
+	if(sdlog_active()) sched_post(&sched, log_id);
+}
+
+// magnitude spectra and levels of both microphones over the last
+// SPECTRUM_POINTS ticks, every SPECTRUM_HOP ticks. The rings are only
+// written by the signal task, which cannot run in the middle of this one.
+static void spectrum_task(void) {
+	PROFILE_START();
+	for(int ix = 0; ix < 2; ++ix) {
+		stats_ring_s16(&mic_ring[ix], SPECTRUM_POINTS, &mic_level[ix]);
+		fft_load_ring(spectrum_work, &mic_ring[ix], SPECTRUM_LOG2);
+		fft_real(spectrum_work, SPECTRUM_LOG2);
+		fft_magnitude(spectrum_work, SPECTRUM_LOG2, spectrum[ix]);
+		PROFILE_STAGE(PROFILE_SPECTRUM);
+	}
+}
+
+// "mic_one level mean -12 dev 850 over 256 ticks" over the UART
+static void level_report(const char* name, const WindowStats* s) {
+	char line[96];
+	int mean = (int)stats_mean(s);
+
+	char* p = put_str(line, name);
+	p = put_str(p, mean < 0 ? " level mean -" : " level mean ");
+	p = put_uint(p, mean < 0 ? -mean : mean);
+	p = put_str(p, " dev ");
+	p = put_uint(p, (unsigned int)stats_deviation(s));
+	p = put_str(p, " over ");
+	p = put_uint(p, s->count);
+	p = put_str(p, " ticks\r\n");
+	uart_put_line(line, p);
+}
+
+// a step of the SD card writes, posted with every telemetry batch
+static void log_task(void) {
+	PROFILE_START();
+	sdlog_service();
+	PROFILE_STAGE(PROFILE_LOG);
+}
+
+// renders the latest deviation and blood pressure estimate, every C3
+void display_task(void) {
+	static char cuff_buff[20];
+	PROFILE_START();
+
+	if(pulse.mean) {					//"BP 120/080(093)"
+		cuff_buff[0] = 'B';
+		cuff_buff[1] = 'P';
+		itos(cuff_buff + 2, pulse.sistolic, 3);
+		itos(cuff_buff + 6, pulse.diastolic, 3);
+		cuff_buff[6] = '/';
+		itos(cuff_buff + 10, pulse.mean, 3);
+		cuff_buff[10] = '(';
+		cuff_buff[14] = ')';
+		cuff_buff[15] = '\0';
+		OLED_fb_puts(1, 1, cuff_buff);
+	}
+	OLED_fb_puts(2, 1, "Cuff Press =    ");
+	itos(cuff_buff, signal_out.deviation, 3);
+	OLED_fb_puts(2, 13, cuff_buff);
+	OLED_flush();
+	PROFILE_STAGE(PROFILE_DISPLAY);
+}
+
+// priority, then deadline from the first post, in us
+void task_setup(void) {
+	BpConfig bp_config;
+
+	bp_default_config(&bp_config);
+	bp_config.rate_hz = SAMPLE_HZ / ENVELOPE_DECIMATE;
+	bp_init(&bp_engine, &bp_config);
+	decimator_init(&envelope, ENVELOPE_DECIMATE, DECIMATE_MAX);
+	fft_init();
+	for(int ix = 0; ix < 2; ++ix)
+		ring_init(&mic_ring[ix], mic_history[ix], SPECTRUM_POINTS, sizeof(int16_t));
+	spectrum_countdown = SPECTRUM_HOP;
+
+	sched_init(&sched);
+	signal_id = sched_add(&sched, "signal", signal_task, 4, TICK_PERIOD_US);
+	pressure_id = sched_add(&sched, "pressure", pressure_task, 3,
+		ENVELOPE_DECIMATE * TICK_PERIOD_US);
+	telemetry_id = sched_add(&sched, "telemetry", telemetry_task, 2,
+		TICK_QUEUE_SIZE / 2 * TICK_PERIOD_US);
+	display_id = sched_add(&sched, "display", display_task, 1, DISPLAY_PERIOD_US);
+	spectrum_id = sched_add(&sched, "spectrum", spectrum_task, 1,
+		SPECTRUM_HOP * TICK_PERIOD_US);
+	log_id = sched_add(&sched, "log", log_task, 0, 80 * TICK_PERIOD_US);
+}
+
+//----------------------------------------------------------------------
+//	The tick only acquires, on the FIQ. Each tick's samples go on the
+//	tick queue for the signal task. The FIQ stub in startup.s stacks
+//	r0-r3, r12 and lr, keeps FPSCR in the banked r8 and stacks d0-d7,
+//	and the sample is taken ahead of any IRQ handler that is running. capture_stats keeps how
+//	long after its deadline each sample was in hand. Build with
+//	TICK_IRQ to take the tick on the IRQ as before, to compare.
+//----------------------------------------------------------------------
+TimerStats	capture_stats;
+
+void fiq_service_routine(void) {
+	static short raw_one = 0, raw_two = 0;
+
+	unsigned int entry = GET32(CLO);
+	unsigned int deadline = timer_service(&tick_job);	//next deadline, clear the match
+	PROFILE_START();
 	
 ////////////////////////////////////////
-		spi_microphones();		//get data from the microphones
-		
-		int mic_val = (int)process_microphones();
-		WriteToRingBuffer( &pulse_data, mic_val);
-		
-		//int signals[RINGBUFFER_SIZE];
-		//thresholding(pulse_data.Buffer, signals, 1, 50, 0.5f);
-		int signalEnd = DetermineDeviation(&pulse_data);
-		//for(int ix = 1; ix < RINGBUFFER_SIZE; ++ix) {
-		//	if( signals[ix - 1] > signals[ix] ) {
-		//		signalEnd = 1;
-		//		break;
-		//	}
-		//}
-					
-		if(!(cuff_pressure++ % 80)) {
-			cuff_val_processed = spi_cuff_pressure()*10 / 135;
-		}
+#ifdef ACQUIRE_PIO
+	spi_microphones();		//get data from the microphones
+	raw_one = mic_one.word;
+	raw_two = mic_two.word;
+#else
+	//last tick's DMA capture, the next one is already running
+	const AcquireSample* sample = acquire_flip(pipeline_due(&pipeline, cuff_stage));
+	if(sample) {
+		raw_one = sample->mic_one;
+		raw_two = sample->mic_two;
+		if(sample->cuff >= 0)
+			cuff_val_processed = cuff_offset(sample->cuff)*10 / 135;
+	}
+#endif
+	timer_record(&capture_stats, GET32(CLO) - deadline);
+	PROFILE_STAGE(PROFILE_MICROPHONES);
 ////////////////////////////////////////
-		
-		if(!(OLED_display++ % 400)) {
-			OLED_pos(1, 2);
-			OLED_puts("bpSure Monitor");
-			OLED_pos(2, 1);
-			OLED_puts("Cuff Press =    ");
-			OLED_pos(2, 13);
-			itos(cuff_buff, signalEnd, 3);
-			OLED_puts(cuff_buff);
-			OLED_pos(2, 13);
-		}
+
+	if(tick_head - tick_sent < TICK_QUEUE_SIZE) {
+		TelemetrySample* t = &tick_queue[tick_head & TICK_QUEUE_MASK];
+		t->time_us = entry;
+		t->mic_one = raw_one;
+		t->mic_two = raw_two;
+		t->cuff = cuff_val_processed;
+		barrier();
+		tick_head++;
+	} else {
+		timing.tick_overruns++;
 	}
+	sched_post(&sched, signal_id);
+
+	pipeline_run(&pipeline);		//button, cuff
+
+	unsigned int elapsed = GET32(CLO) - entry;
+	timing.isr_last_us = elapsed;
+	if(elapsed > timing.isr_max_us) timing.isr_max_us = elapsed;
 }
 
 //----------------------------------------------------------------------
-void _main_ (unsigned int earlypc) {
+void irq_service_routine(void) {
+    unsigned int irq_pending1;
+
+    irq_pending1=GET32(IRQ_PEND1);
+#ifdef TICK_IRQ
+	if(irq_pending1 & TIMER_IRQ(&tick_job)) {
+		fiq_service_routine();
+	}
+#endif
+
+	if(irq_pending1 & TIMER_IRQ(&display_job)) {
+		timer_service(&display_job);
+		sched_post(&sched, display_id);
+	}
+
+	if(irq_pending1 & UART_IRQ) {
+		uart_isr();
+	}
+}
+
 //----------------------------------------------------------------------
+//	System Initialization, everything _main_ does before its loop
+//----------------------------------------------------------------------
+void system_init(void) {
    disable_irq();
 
    PUT32(IRQ_DISABLE1, 0xFF); 
@@ -317,41 +630,99 @@ void _main_ (unsigned int earlypc) {
 	gpioMODE(17, INPUT);	// front panel switch in
 	gpioMODE(24, OUTPUT);	// front panel switch out        
 
-	unsigned int STAT_REG;
-		
     //UART init
 	uart_init();
    GET8(AUX_MU_IO_REG);
     
    //SPI init
    spi_init();
+#ifndef ACQUIRE_PIO
+	acquire_init();
+#endif
+
+	//SD card log, blocks on the card so before the timers start
+	sdlog_mount();
     	    
-	//clock init
-	PUT32(C1,(GET32(CLO) + 0x000004E1));
-	PUT32(CS,2);
-	PUT32(IRQ_ENABLE1, 2);
+	//signal path state, before the first tick can use it
+	signal_init();
+	InitPulseInfo(&pulse);
+	task_setup();
+	pipeline_setup();
+
+	//clock init, C1 and C3 are free, the GPU has C0 and C2
+	timer_start(&tick_job, 1, TICK_PERIOD_US);
+	timer_start(&display_job, 3, DISPLAY_PERIOD_US);
+#ifdef TICK_IRQ
+	PUT32(IRQ_ENABLE1, TIMER_IRQ(&tick_job) | TIMER_IRQ(&display_job));
+#else
+	PUT32(IRQ_FIQ_CONTROL, FIQ_ENABLE | tick_job.channel);	//C1 is IRQ 1
+	PUT32(IRQ_ENABLE1, TIMER_IRQ(&display_job));
+#endif
 	enable_irq();
 
 	//OLED init
 	OLED_init();
 	
-	OLED_pos(1, 2);
-	OLED_puts("bpSure Monitor");
-	OLED_pos(2, 1);
-	OLED_puts("                  ");
+	OLED_fb_puts(1, 2, "bpSure Monitor");
+	OLED_flush();
+}
 
-	InitRingBuffer(&pulse_data);
+//----------------------------------------------------------------------
+void _main_ (unsigned int earlypc) {
+//----------------------------------------------------------------------
+	int format_armed = 0;
+
+	system_init();
 
 	while(1) {
+		if(sched_run(&sched) >= 0) continue;	//tasks first, the console when idle
 		gpioWR(24, SW1);
-		STAT_REG = GET32(AUX_MU_STAT_REG);
-		
-		if(STAT_REG & (1<<0)) { 	//recr FIF0 contains one byte
-			UART_RX();
+
+		int c = uart_getc();
+		if(format_armed && c != COM_RX_BUFFER_EMPTY) {	//'F' then 'Y' formats
+			format_armed = 0;
+			if(c == 'Y') {
+				uart_puts(sdlog_format() ? "log format failed\r\n" : "log formatted\r\n");
+				continue;
+			}
 		}
 
-		if(STAT_REG & (1<<1)) { 	//xmtr FIFO can accept one byte
-			UART_TX();
+		switch(c) {
+			case 'T': telemetry_enable(1); break;	//start binary telemetry
+			case 't': telemetry_enable(0); break;
+			case 'J':							//deadline lateness and ISR time, us
+				timer_report("tick", &tick_job.stats);
+				timer_report("capture", &capture_stats);
+				timer_report("display", &display_job.stats);
+				timing_report();
+				break;
+			case 'j':
+				timer_reset(&tick_job.stats);
+				timer_reset(&capture_stats);
+				timer_reset(&display_job.stats);
+				timing.isr_max_us = 0;
+				break;
+			case 'S': sched_report(&sched); break;	//task latency and runtime
+			case 's': sched_reset(&sched); break;
+			case 'L': sdlog_start(); break;		//log a session to the SD card
+			case 'l': sdlog_stop(); break;
+			case 'M': sdlog_report(); break;
+			case 'F':							//drops every logged session
+				if(sdlog_state() == SDLOG_READY || sdlog_state() == SDLOG_FULL) {
+					uart_puts("log format drops every session, Y to confirm\r\n");
+					format_armed = 1;
+				} else uart_puts("log format refused, the log is not idle\r\n");
+				break;
+			case 'X':							//microphone spectra, peak bin, level
+				fft_report("mic_one", spectrum[0], SPECTRUM_LOG2, (unsigned int)SAMPLE_HZ);
+				level_report("mic_one", &mic_level[0]);
+				fft_report("mic_two", spectrum[1], SPECTRUM_LOG2, (unsigned int)SAMPLE_HZ);
+				level_report("mic_two", &mic_level[1]);
+				break;
+#ifdef PROFILE
+			case 'P': profile_report(); break;	//ISR stage cycle counts
+			case 'p': profile_reset(); break;
+#endif
 		}
 	}
 }
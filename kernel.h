@@ -0,0 +1,52 @@
+/**********************************************************************/
+//	kernel.h   October 17, 2026
+/**********************************************************************/
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include "pipeline.h"
+#include "timer.h"
+#include "sched.h"
+
+#define SAMPLE_HZ			800.0f		// timer tick rate
+#define ENVELOPE_DECIMATE	10			// blood pressure at 80 Hz
+
+// NLMS noise canceller, mic_two as the reference for mic_one
+#define CANCEL_TAPS			32
+#define CANCEL_MU			0.05f
+#define CANCEL_EPS			1000.0f		// floor under the reference power
+
+// ISR timing in system timer microseconds, and queue overruns
+typedef struct {
+	unsigned int isr_last_us;
+	unsigned int isr_max_us;
+	unsigned int tick_overruns;		//ticks lost, the tick queue was full
+	unsigned int block_overruns;	//envelope blocks lost before bp_update
+} TimingStats;
+
+extern volatile TimingStats timing;
+
+// one tick of the signal path, in the raw product scale either way
+typedef struct {
+	int product;		//process_microphones
+	int deviation;		//DetermineDeviation over the window
+	int signal;			//z-score detector, -1, 0 or 1
+} SignalOutput;
+
+extern volatile unsigned int pulse_count;
+extern Pipeline pipeline;
+extern Scheduler sched;
+extern TimerJob tick_job, display_job;
+extern TimerStats capture_stats;
+
+void system_init(void);
+void signal_init(void);
+void signal_step(short mic_one, short mic_two, SignalOutput* out);
+void pipeline_setup(void);
+void task_setup(void);
+void display_task(void);
+void fiq_service_routine(void);
+void irq_service_routine(void);
+void _main_(unsigned int earlypc);
+
+#endif /* KERNEL_H */
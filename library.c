@@ -104,6 +104,23 @@ int itos(char* str, int num, int numdigits) {
 	return startIndex + numdigits;
 } 
 
+//------------------------------------------------------------------------------ 
+// Append a string or an unsigned decimal to a line being built, return the
+// new end. Neither writes a terminator, see uart_put_line.
+//------------------------------------------------------------------------------ 
+char* put_str(char* out, const char* s) {
+	while(*s) *out++ = *s++;
+	return out;
+}
+
+char* put_uint(char* out, unsigned int v) {
+	char digits[10];
+	int n = 0;
+	do { digits[n++] = '0' + v % 10; v /= 10; } while(v);
+	while(n) *out++ = digits[--n];
+	return out;
+}
+
 //------------------------------------------------------------------------------ 
 // Converts a floating point number to an ASCII String
 //------------------------------------------------------------------------------  
@@ -133,20 +150,141 @@ void ftos(char *str, double num, int digits) {
 }
 
 //------------------------------------------------------------------------------
+// memset, memcpy and memmove. Whole words once the destination is word
+// aligned, and 32 byte LDM/STM bursts on the ARM, with byte loops only
+// for the unaligned head and tail. A source that cannot be aligned with
+// the destination is read as aligned words and shifted into place, since
+// the ARM1176 is not set up for unaligned LDR.
+//
+// The byte loops here must not be turned back into calls to themselves,
+// which gcc's loop pattern matching would otherwise do at -O3.
+//------------------------------------------------------------------------------
+#define NO_LIBCALLS __attribute__((optimize("no-tree-loop-distribute-patterns")))
+
+typedef uint32_t __attribute__((may_alias)) word_t;
+
+#define BURST_BYTES 32
+
+static inline void burst_copy(word_t* d, const word_t* s) {
+#ifdef __arm__
+	__asm__ volatile(
+		"ldmia %1, {r3-r9, r12}\n\t"
+		"stmia %0, {r3-r9, r12}"
+		: : "r"(d), "r"(s)
+		: "r3", "r4", "r5", "r6", "r7", "r8", "r9", "r12", "memory");
+#else
+	word_t a = s[0], b = s[1], c = s[2], e = s[3];
+	word_t f = s[4], g = s[5], h = s[6], k = s[7];
+	d[0] = a; d[1] = b; d[2] = c; d[3] = e;
+	d[4] = f; d[5] = g; d[6] = h; d[7] = k;
+#endif
+}
+
+static inline void burst_fill(word_t* d, uint32_t w) {
+#ifdef __arm__
+	__asm__ volatile(
+		"mov r3, %1\n\t"
+		"mov r4, %1\n\t"
+		"mov r5, %1\n\t"
+		"mov r6, %1\n\t"
+		"mov r7, %1\n\t"
+		"mov r8, %1\n\t"
+		"mov r9, %1\n\t"
+		"mov r12, %1\n\t"
+		"stmia %0, {r3-r9, r12}"
+		: : "r"(d), "r"(w)
+		: "r3", "r4", "r5", "r6", "r7", "r8", "r9", "r12", "memory");
+#else
+	d[0] = w; d[1] = w; d[2] = w; d[3] = w;
+	d[4] = w; d[5] = w; d[6] = w; d[7] = w;
+#endif
+}
+
+NO_LIBCALLS void* memset( void* m, int val, size_t numBytes ) {
+	unsigned char* ptr = m;
+	uint32_t w = (unsigned char)val * 0x01010101u;
 
-void memset( void* m, char val, int numBytes ) {
-	char* ptr = (char*)m;
-	for( int ix = 0; ix < numBytes; ++ix ) {
-		ptr[ix] = val;
+	while( numBytes && ((uintptr_t)ptr & 3) ) {
+		*ptr++ = val;
+		--numBytes;
+	}
+	for( ; numBytes >= BURST_BYTES; numBytes -= BURST_BYTES, ptr += BURST_BYTES ) {
+		burst_fill((word_t*)ptr, w);
+	}
+	for( ; numBytes >= 4; numBytes -= 4, ptr += 4 ) {
+		*(word_t*)ptr = w;
+	}
+	while( numBytes-- ) {
+		*ptr++ = val;
+	}
+	return m;
+}
+
+NO_LIBCALLS void* memcpy( void* dest, const void* src, size_t numBytes ) {
+	unsigned char* d = dest;
+	const unsigned char* s = src;
+
+	while( numBytes && ((uintptr_t)d & 3) ) {
+		*d++ = *s++;
+		--numBytes;
+	}
+
+	unsigned int offset = (uintptr_t)s & 3;
+	if( offset == 0 ) {
+		for( ; numBytes >= BURST_BYTES; numBytes -= BURST_BYTES ) {
+			burst_copy((word_t*)d, (const word_t*)s);
+			d += BURST_BYTES;
+			s += BURST_BYTES;
+		}
+		for( ; numBytes >= 4; numBytes -= 4, d += 4, s += 4 ) {
+			*(word_t*)d = *(const word_t*)s;
+		}
+	}
+	else if( numBytes >= 8 ) {
+		// little endian, each word is the top of one aligned source word
+		// and the bottom of the next. The last aligned word read ends
+		// inside the source.
+		unsigned int right = offset * 8, left = 32 - right;
+		const word_t* sw = (const word_t*)(s - offset);
+		uint32_t lo = *sw++;
+		for( ; numBytes >= 8; numBytes -= 4, d += 4, s += 4 ) {
+			uint32_t hi = *sw++;
+			*(word_t*)d = (lo >> right) | (hi << left);
+			lo = hi;
+		}
 	}
+	while( numBytes-- ) {
+		*d++ = *s++;
+	}
+	return dest;
 }
 
-void memcpy( void* dest, const void* src, int numBytes ) {
-	char* d = dest;
-	const char* s = src;
-	for( int ix = 0; ix < numBytes; ++ix ) {
-		d[ix] = s[ix];
+// copies that overlap with the destination above the source run backwards
+NO_LIBCALLS void* memmove( void* dest, const void* src, size_t numBytes ) {
+	unsigned char* d = dest;
+	const unsigned char* s = src;
+
+	if( d <= s || d >= s + numBytes ) {
+		return memcpy(dest, src, numBytes);
+	}
+
+	d += numBytes;
+	s += numBytes;
+	if( (((uintptr_t)d ^ (uintptr_t)s) & 3) == 0 ) {
+		while( numBytes && ((uintptr_t)d & 3) ) {
+			*--d = *--s;
+			--numBytes;
+		}
+		for( ; numBytes >= 4; numBytes -= 4 ) {
+			d -= 4;
+			s -= 4;
+			*(word_t*)d = *(const word_t*)s;
+		}
+	}
+	while( numBytes-- ) {
+		*--d = *--s;
 	}
+	return dest;
 }
 
 //------------------------------------------------------------------------------
@@ -154,40 +292,60 @@ void memcpy( void* dest, const void* src, int numBytes ) {
 void InitPulseInfo(PulseInfo* info) {
 	info->sistolic = 0;
 	info->diastolic = 0;
+	info->mean = 0;
 }
  
 //------------------------------------------------------------------------------
 
 void InitRingBuffer( RingBuffer* buffer ) {
 	buffer->Write_Index = 0;
-	
-	for( int ix = 0; ix < RINGBUFFER_SIZE; ++ix ) {
-		buffer->Buffer[ix] = 0;
-	}
+	buffer->Sum = 0;
+	buffer->SumSquares = 0;
+	buffer->NextSumSquares = 0;
+	memset(buffer->Buffer, 0, sizeof(buffer->Buffer));
 }
 
 int WriteToRingBuffer( RingBuffer* buffer, int val ) {
+	int old = buffer->Buffer[buffer->Write_Index];
+	double square = (double)val * val;
+
 	buffer->Buffer[buffer->Write_Index] = val;
-	buffer->Write_Index = (buffer->Write_Index + 1) % RINGBUFFER_SIZE;
+	buffer->Sum += val - old;
+	buffer->SumSquares += square - (double)old * old;
+	buffer->NextSumSquares += square;
+
+	buffer->Write_Index = (buffer->Write_Index + 1) & RINGBUFFER_MASK;
+	if( buffer->Write_Index == 0 ) {
+		// every entry has been rewritten since the last wrap, so the
+		// fresh accumulator is the exact sum of squares of the window
+		buffer->SumSquares = buffer->NextSumSquares;
+		buffer->NextSumSquares = 0;
+	}
 	return RETURN_SUCCESS;	
 }
 
+// offset 0 is the oldest sample and -1 the newest, either way round
 int ReadFromRingBuffer( const RingBuffer* buffer, int offset ) {
-	int index = -1;
-	if( offset >= 0 ) {
-		index = (buffer->Write_Index + offset) % RINGBUFFER_SIZE;
-	} else {
-		index = (buffer->Write_Index + offset);
-		if( index < 0 ) {
-			index = RINGBUFFER_SIZE + index;
-		}
-	}
-	
-	return buffer->Buffer[index];
+	return buffer->Buffer[(buffer->Write_Index + offset) & RINGBUFFER_MASK];
 }
 
 float DetermineAverage( const RingBuffer* buffer ) {
-	int sum = 0;
+	return (float)buffer->Sum / RINGBUFFER_SIZE;
+}
+
+float DetermineDeviation(const RingBuffer* buffer ) {
+	double sum = (double)buffer->Sum;
+	double devSqrSum = buffer->SumSquares - sum * sum / RINGBUFFER_SIZE;
+	
+	if( devSqrSum <= 0 ) return 0;
+	return (float)sqrt(devSqrSum / (RINGBUFFER_SIZE - 1));
+}
+
+//------------------------------------------------------------------------------
+// two pass reference versions, a full scan of the window per call
+//------------------------------------------------------------------------------
+float DetermineAverageFull( const RingBuffer* buffer ) {
+	long long sum = 0;
 	for( int ix = 0; ix < RINGBUFFER_SIZE; ++ix ) {
 		sum += buffer->Buffer[ix];
 	}
@@ -195,8 +353,8 @@ float DetermineAverage( const RingBuffer* buffer ) {
 	return (float)sum / RINGBUFFER_SIZE;
 }
 
-float DetermineDeviation(const RingBuffer* buffer ) {
-	float average = DetermineAverage(buffer);
+float DetermineDeviationFull(const RingBuffer* buffer ) {
+	float average = DetermineAverageFull(buffer);
 	
 	float devSqrSum = 0;
 	for( int ix = 0; ix < RINGBUFFER_SIZE; ++ix) {
@@ -4,12 +4,16 @@
 #ifndef LIBRARY_H
 #define LIBRARY_H
 
+#include <stddef.h>
+
 unsigned int bcd2dec(unsigned int);
 unsigned int dec2bcd(unsigned int);
 void reverse(char *, int);
 void dec2hex(int, char *, int);
 long hex2dec(char *);
 int itos(char *, int, int);
+char* put_str(char *, const char *);
+char* put_uint(char *, unsigned int);
 void ftos(char *, double, int);
  
 #define COM_BUFFER_FULL  0x1F00
@@ -22,21 +26,36 @@ void ftos(char *, double, int);
 #define true	1
 #define false  0
 
-void memset( void* m, char val, int numBytes );
-void memcpy( void* dest, const void* src, int numBytes );
+void* memset( void* m, int val, size_t numBytes );
+void* memcpy( void* dest, const void* src, size_t numBytes );
+void* memmove( void* dest, const void* src, size_t numBytes );
 
 #define PULSE_VAL_THRESHOLD 100
 typedef struct _PulseInfo {
 	int		sistolic;
 	int		diastolic;
+	int		mean;			// mean arterial pressure
 } PulseInfo;
 
 void  InitPulseInfo(PulseInfo* info);
 
+#ifndef RINGBUFFER_SIZE
 #define RINGBUFFER_SIZE  32
+#endif
+#define RINGBUFFER_MASK  (RINGBUFFER_SIZE - 1)	// a power of two, see ring.h
+
+typedef char ringbuffer_size_is_a_power_of_two[
+	(RINGBUFFER_SIZE & RINGBUFFER_MASK) == 0 ? 1 : -1];
+// Sum and SumSquares track the window as it is written so the mean and
+// deviation cost O(1) per sample. Sum is exact. SumSquares is a double
+// and drifts, so it is replaced by NextSumSquares, which accumulates the
+// squares written since Write_Index last wrapped, every time it wraps.
 typedef struct _RingBuffer {
 	int Buffer[RINGBUFFER_SIZE];
 	int Write_Index;
+	long long Sum;
+	double SumSquares;
+	double NextSumSquares;
 } RingBuffer;
 
 void InitRingBuffer( RingBuffer* buffer );
@@ -46,4 +65,6 @@ void	PrintRingBuffer(const RingBuffer* buffer);
 
 float DetermineAverage( const RingBuffer* buffer );
 float DetermineDeviation(const RingBuffer* buffer );
+float DetermineAverageFull( const RingBuffer* buffer );
+float DetermineDeviationFull(const RingBuffer* buffer );
 #endif /* LIBRARY_H */
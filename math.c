@@ -5,6 +5,7 @@
 * 
 *******************************************************************************/
 #include "math.h"
+#include "library.h"
   
 //------------------------------------------------------------------------------
 complex Complex(float re, float im) {
@@ -253,35 +254,47 @@ double _cosine(double x) {
 }
 
 //------------------------------------------------------------------------------
-// Returns the sine of an angle in radians 
+// Reduce x to the nearest multiple of pi/2, r in -45 .. +45, and evaluate
+// the quadrant. pi/2 is split Cody-Waite style so n * PIO2_HI is exact.
 //------------------------------------------------------------------------------
-double sin(double x) {
-  double retval = 0;
-	long n = (long)(x / 2.070796327);
-	x -= n * 1.570796327;
-	n = mod(n, (long)4);
+#define TWO_OVER_PI	0.636619772367581343
+#define PIO2_HI		1.57079632673412561		// upper 33 bits of pi/2
+#define PIO2_LO		6.07710050650619225e-11	// pi/2 - PIO2_HI
 
-	switch(n) {
+static double _sin_quadrant(double x, long shift) {
+	double retval = 0;
+	double t = x * TWO_OVER_PI;
+	long n = (long)(t < 0 ? t - 0.5 : t + 0.5);
+	x = (x - n * PIO2_HI) - n * PIO2_LO;
+
+	switch((n + shift) & 3) {
 		case 0:
-      	retval = _sine(x);
-        break;
+			retval = _sine(x);
+			break;
 		case 1:
-      	retval = _cosine(x);
-        break;
+			retval = _cosine(x);
+			break;
 		case 2:
-      	retval = -_sine(x);
-        break;
+			retval = -_sine(x);
+			break;
 		case 3:
-      	retval = -_cosine(x);
+			retval = -_cosine(x);
 	}
-  return retval;
+	return retval;
+}
+
+//------------------------------------------------------------------------------
+// Returns the sine of an angle in radians 
+//------------------------------------------------------------------------------
+double sin(double x) {
+	return _sin_quadrant(x, 0);
 }
 
 //------------------------------------------------------------------------------
 // Returns the cosine of an angle in radians 
 //------------------------------------------------------------------------------
 double cos(double x) {
-	return sin(x + 1.570796327);
+	return _sin_quadrant(x, 1);
 }
 
 //------------------------------------------------------------------------------
@@ -293,14 +306,15 @@ void sincos(double x, double *s, double *c) {
 	double sin_30 = 0.5;
 	double cos_30 = 0.866025404;
   
-	long n = (long)(x/pi_over_six + 0.5);
+	double t = x/pi_over_six;
+	long n = (long)(t < 0 ? t - 0.5 : t + 0.5);	// nearest, either sign
 	x -= (double)n * pi_over_six;
 	n = n % 12;
 	if(n < 0)
 		n += 12;
 	float z = x*x;
 	float s1 = ((z/20.0-1)*z/6.0+1.0)*x;
-	float c1 = ((z/30.0 +1.0)*z/12.0-1.0)*z/2.0+1.0;
+	float c1 = ((-z/30.0 +1.0)*z/12.0-1.0)*z/2.0+1.0;
 
 	switch(n){
 	   case 0:
@@ -421,30 +435,72 @@ double fabs(double float_num) {
 }   
 
 #include "library.h"
+//------------------------------------------------------------------------------
+// Batch z-score thresholding over a RINGBUFFER_SIZE window, kept for
+// callers that want a whole window of signals. It simply streams the
+// window through a ZScoreDetector.
+//------------------------------------------------------------------------------
 void thresholding(int y[], int signals[], int lag, float threshold, float influence) {
-    //memset(signals, 0, sizeof(int) * RINGBUFFER_SIZE);
-    static float filteredY[RINGBUFFER_SIZE];
-    memcpy(filteredY, y, sizeof(int) * RINGBUFFER_SIZE);
-    static float avgFilter[RINGBUFFER_SIZE];
-    static float stdFilter[RINGBUFFER_SIZE];
-
-    avgFilter[lag - 1] = meani(y, lag);
-    stdFilter[lag - 1] = stddevi(y, lag);
-
-    for (int i = lag; i < RINGBUFFER_SIZE; i++) {
-        if (fabs(y[i] - avgFilter[i-1]) > threshold * stdFilter[i-1]) {
-            if (y[i] > avgFilter[i-1]) {
-                signals[i] = 1;
-            } else {
-                signals[i] = -1;
-            }
-            filteredY[i] = influence * y[i] + (1 - influence) * filteredY[i-1];
-        } else {
-            signals[i] = 0;
+    ZScoreDetector det;
+    InitZScore(&det, lag, threshold, influence);
+
+    for (int i = 0; i < RINGBUFFER_SIZE; i++) {
+        signals[i] = ZScoreUpdate(&det, y[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Streaming z-score peak detector
+//------------------------------------------------------------------------------
+void InitZScore(ZScoreDetector* det, int lag, float threshold, float influence) {
+    if (lag < 2) lag = 2;
+    if (lag > ZSCORE_MAX_LAG) lag = ZSCORE_MAX_LAG;
+
+    det->lag = lag;
+    det->threshold = threshold;
+    det->influence = influence;
+    det->index = 0;
+    det->count = 0;
+    det->sum = det->squares = 0;
+    det->next_sum = det->next_squares = 0;
+    memset(det->filtered, 0, lag * sizeof(det->filtered[0]));
+}
+
+// Returns 1 for a sample above the band, -1 below it and 0 inside it.
+// Nothing is signalled until the first lag samples have been seen.
+int ZScoreUpdate(ZScoreDetector* det, float y) {
+    int signal = 0;
+    float value = y;
+
+    if (det->count >= det->lag) {
+        double avg = det->sum / det->lag;
+        double var = (det->squares - det->sum * avg) / (det->lag - 1);
+        float std = var > 0 ? sqrt(var) : 0;
+
+        if (fabs(y - avg) > det->threshold * std) {
+            signal = (y > avg) ? 1 : -1;
+            int last = (det->index == 0 ? det->lag : det->index) - 1;
+            value = det->influence * y + (1 - det->influence) * det->filtered[last];
         }
-        avgFilter[i] = meanf(filteredY + i-lag, lag);
-        stdFilter[i] = stddevf(filteredY + i-lag, lag);
+    } else {
+        det->count++;
+    }
+
+    float old = det->filtered[det->index];
+    det->filtered[det->index] = value;
+    det->sum += (double)value - old;
+    det->squares += (double)value * value - (double)old * old;
+    det->next_sum += value;
+    det->next_squares += (double)value * value;
+
+    if (++det->index == det->lag) {
+        // the whole window was rewritten since the last wrap
+        det->index = 0;
+        det->sum = det->next_sum;
+        det->squares = det->next_squares;
+        det->next_sum = det->next_squares = 0;
     }
+    return signal;
 }
 
 float meani(int data[], int len) {
@@ -5,6 +5,7 @@
 
 /******************************************************************************/
 #include <stdio.h>
+#include <stdint.h>
 
 #ifndef INC_MATH_H
 #define INC_MATH_H
@@ -41,7 +42,7 @@ typedef struct {
 //------------------------------------------------------------------------------
 typedef union {
 	float fpn;				// floating point number
-	unsigned long uln;	// unsigned long number
+	uint32_t uln;			// unsigned 32 bit number
 } float_structure; 
 
 //------------------------------------------------------------------------------
@@ -51,12 +52,33 @@ typedef union {
 typedef union {
 	double fpn;
 	struct {
-		unsigned long ulo;
-		unsigned long uhi;
+		uint32_t ulo;
+		uint32_t uhi;
 	} n;
 } double_structure;
 
 
+//------------------------------------------------------------------------------
+// streaming z-score peak detector, one sample in and one signal out.
+// The mean and deviation of the last lag filtered samples are kept as
+// running sums, resynced from next_sum/next_squares each time index
+// wraps, so every update costs the same regardless of lag.
+//------------------------------------------------------------------------------
+#define ZSCORE_MAX_LAG 64
+
+typedef struct {
+	float filtered[ZSCORE_MAX_LAG];	// last lag filtered samples
+	int index;
+	int count;
+	int lag;
+	float threshold;
+	float influence;
+	double sum;
+	double squares;
+	double next_sum;
+	double next_squares;
+} ZScoreDetector;
+
 //------------------------------------------------------------------------------
 complex Complex(float, float);
 complex Add(complex, complex); 
@@ -86,6 +108,8 @@ float meanf(float data[], int len);
 float stddevi(int data[], int len);
 float meani(int data[], int len);
 void thresholding(int y[], int signals[], int lag, float threshold, float influence);
+void InitZScore(ZScoreDetector* det, int lag, float threshold, float influence);
+int ZScoreUpdate(ZScoreDetector* det, float y);
 #endif
 
 //-----------------------------------------------------------------------------
@@ -0,0 +1,103 @@
+/**********************************************************************/
+//	mmu.c   October 17, 2026
+/***********************************************************************
+	MMU, L1 caches and branch prediction for the ARM1176, called from
+	startup.s before _main_.
+
+	A flat one level table of 1MB sections maps every address onto
+	itself. SDRAM, the first 512MB, is normal memory, write-back with
+	write allocate. The peripheral window at 0x20000000 is shared device
+	memory, never cached, never executed, and every register access
+	still completes in program order. Anything else faults.
+
+	The table takes 16KB on a 16KB boundary. It sits at 1MB, clear of
+	the image at 0x8000, which memmap stops short of it, and of the SVC
+	stack coming down from 128MB, so it does not bloat kernel.bin.
+
+	make CACHES_OFF=1 leaves all of it off, for before and after ISR
+	timings of the same image with make PROFILE=1.
+***********************************************************************/
+#include "hal.h"
+
+#define MMU_TABLE			((volatile unsigned int*)0x00100000)
+#define MMU_SECTIONS		4096
+
+// short descriptor section bits, ARMv6 with SCTLR.XP set
+#define SECTION				0x2
+#define SECTION_B			(1 << 2)
+#define SECTION_C			(1 << 3)
+#define SECTION_XN			(1 << 4)
+#define SECTION_AP_RW		(3 << 10)
+#define SECTION_TEX(n)		((n) << 12)
+
+#define SECTION_NORMAL		(SECTION | SECTION_AP_RW | SECTION_TEX(1) | \
+							 SECTION_C | SECTION_B)		//write-back, write allocate
+#define SECTION_DEVICE		(SECTION | SECTION_AP_RW | SECTION_XN | SECTION_B)
+
+#define RAM_END				0x20000000
+#define PERIPHERAL_BASE		0x20000000
+#define PERIPHERAL_END		0x21000000
+
+// SCTLR bits
+#define SCTLR_M				(1 << 0)	// MMU
+#define SCTLR_C				(1 << 2)	// data cache
+#define SCTLR_Z				(1 << 11)	// branch prediction
+#define SCTLR_I				(1 << 12)	// instruction cache
+#define SCTLR_XP			(1 << 23)	// ARMv6 page table format
+
+#define CACHE_LINE			32
+
+//----------------------------------------------------------------------
+void mmu_init(void) {
+#ifndef CACHES_OFF
+	unsigned int sctlr;
+
+	for(unsigned int ix = 0; ix < MMU_SECTIONS; ++ix) {
+		unsigned int base = ix << 20;
+		unsigned int desc = 0;							//fault
+		if(base < RAM_END)
+			desc = base | SECTION_NORMAL;
+		else if(base >= PERIPHERAL_BASE && base < PERIPHERAL_END)
+			desc = base | SECTION_DEVICE;
+		MMU_TABLE[ix] = desc;
+	}
+
+	__asm__ volatile(
+		"mcr p15, 0, %0, c7, c7, 0\n"	//invalidate both caches
+		"mcr p15, 0, %0, c8, c7, 0\n"	//invalidate the TLBs
+		"mcr p15, 0, %0, c7, c10, 4\n"	//drain the write buffer
+		"mcr p15, 0, %0, c2, c0, 2\n"	//TTBCR, TTBR0 for everything
+		"mcr p15, 0, %1, c2, c0, 0\n"	//TTBR0
+		"mcr p15, 0, %2, c3, c0, 0\n"	//domain 0 client, checks AP
+		: : "r"(0), "r"((unsigned int)MMU_TABLE), "r"(1) : "memory");
+
+	__asm__ volatile("mrc p15, 0, %0, c1, c0, 0" : "=r"(sctlr));
+	sctlr |= SCTLR_M | SCTLR_C | SCTLR_Z | SCTLR_I | SCTLR_XP;
+	__asm__ volatile(
+		"mcr p15, 0, %0, c1, c0, 0\n"
+		"mcr p15, 0, %1, c7, c5, 6\n"	//flush the branch target cache
+		"mcr p15, 0, %1, c7, c5, 4\n"	//flush the prefetch buffer
+		: : "r"(sctlr), "r"(0) : "memory");
+#endif
+}
+
+//----------------------------------------------------------------------
+//	data cache maintenance by address, a line at a time, see hal.h
+//----------------------------------------------------------------------
+void hal_cache_clean(const volatile void* ptr, unsigned int size) {
+	unsigned int line = (unsigned int)ptr & ~(CACHE_LINE - 1);
+	unsigned int end = (unsigned int)ptr + size;
+
+	for(; line < end; line += CACHE_LINE)
+		__asm__ volatile("mcr p15, 0, %0, c7, c10, 1" : : "r"(line) : "memory");
+	__asm__ volatile("mcr p15, 0, %0, c7, c10, 4" : : "r"(0) : "memory");
+}
+
+void hal_cache_invalidate(const volatile void* ptr, unsigned int size) {
+	unsigned int line = (unsigned int)ptr & ~(CACHE_LINE - 1);
+	unsigned int end = (unsigned int)ptr + size;
+
+	for(; line < end; line += CACHE_LINE)
+		__asm__ volatile("mcr p15, 0, %0, c7, c6, 1" : : "r"(line) : "memory");
+	__asm__ volatile("mcr p15, 0, %0, c7, c10, 4" : : "r"(0) : "memory");
+}
@@ -0,0 +1,98 @@
+/**********************************************************************/
+//	nlms.c   October 17, 2026
+/***********************************************************************
+	NLMS canceller, see nlms.h. The sample leaving the filter's window
+	is read out of the ring before the new one goes in, so the power
+	sum stays exact without a rescan.
+
+	In Q15 a weight update is mu_q15 e x / 2^bits, where 2^bits is the
+	power of two above eps + x.x, taken to Q28 by shifting by
+	bits - 13 in all, left when bits is smaller. The error is saturated
+	to Q15 first, so mu_q15 e is under 2^31, times x under 2^46 and
+	shifted left by at most 12, still inside 64 bits. Q28 only holds
+	weights within +-8, so the update is saturated to Q31 and added
+	with saturation. A quiet reference against a loud primary then pins
+	its weights at the limit instead of wrapping them round.
+***********************************************************************/
+#include "nlms.h"
+#include "library.h"
+
+#define NLMS_Q		28
+
+//----------------------------------------------------------------------
+// 0, or -1 for a tap count or step out of range
+int nlms_init(Nlms* f, int taps, float mu, float eps) {
+	if(taps < 1 || taps > NLMS_MAX_TAPS || mu <= 0 || mu >= 2) return -1;
+	f->taps = taps;
+	f->mu = mu;
+	f->eps = eps < 1 ? 1 : eps;
+	f->mu_q15 = (int32_t)(mu * 32768.0f + 0.5f);
+	ring_init(&f->ring, f->history, NLMS_MAX_TAPS, sizeof(int16_t));
+	nlms_reset(f);
+	return 0;
+}
+
+void nlms_reset(Nlms* f) {
+	memset(f->w, 0, sizeof(f->w));
+	memset(f->w_q28, 0, sizeof(f->w_q28));
+	ring_clear(&f->ring);
+	f->power = 0;
+}
+
+// takes in the reference sample and returns the filter's window
+static int push(Nlms* f, q15_t reference, RingSpan span[2]) {
+	int32_t old = RING_AT(&f->ring, int16_t, NLMS_MAX_TAPS - f->taps);
+	f->power += (int32_t)reference * reference - old * old;
+	RING_PUSH(&f->ring, int16_t, reference);
+	return ring_window(&f->ring, f->taps, span);
+}
+
+//----------------------------------------------------------------------
+float nlms_run(Nlms* f, q15_t reference, q15_t primary) {
+	RingSpan span[2];
+	int spans = push(f, reference, span);
+	float y = 0;
+
+	float* w = f->w;
+	for(int sx = 0; sx < spans; ++sx) {
+		const int16_t* x = span[sx].data;
+		for(unsigned int ix = 0; ix < span[sx].count; ++ix) y += *w++ * x[ix];
+	}
+
+	float e = primary - y;
+	float g = f->mu * e / (f->eps + (float)f->power);
+	w = f->w;
+	for(int sx = 0; sx < spans; ++sx) {
+		const int16_t* x = span[sx].data;
+		for(unsigned int ix = 0; ix < span[sx].count; ++ix) *w++ += g * x[ix];
+	}
+	return e;
+}
+
+q15_t nlms_run_q15(Nlms* f, q15_t reference, q15_t primary) {
+	RingSpan span[2];
+	int spans = push(f, reference, span);
+	int64_t acc = 0;
+
+	int32_t* w = f->w_q28;
+	for(int sx = 0; sx < spans; ++sx) {
+		const int16_t* x = span[sx].data;
+		for(unsigned int ix = 0; ix < span[sx].count; ++ix) acc += (int64_t)*w++ * x[ix];
+	}
+
+	q15_t e = q15_sat(primary - ((acc + (1 << (NLMS_Q - 1))) >> NLMS_Q));
+	uint64_t norm = (uint64_t)f->power + (uint64_t)f->eps;
+	int shift = 64 - __builtin_clzll(norm) + 15 - NLMS_Q;
+	int64_t g = (int64_t)f->mu_q15 * e;
+	int64_t round = shift > 0 ? (int64_t)1 << (shift - 1) : 0;
+	w = f->w_q28;
+	for(int sx = 0; sx < spans; ++sx) {
+		const int16_t* x = span[sx].data;
+		for(unsigned int ix = 0; ix < span[sx].count; ++ix, ++w) {
+			int64_t step = g * x[ix];
+			step = shift > 0 ? (step + round) >> shift : step << -shift;	//a quiet reference
+			*w = q31_add(*w, q31_sat(step));
+		}
+	}
+	return e;
+}
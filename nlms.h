@@ -0,0 +1,53 @@
+/**********************************************************************/
+//	nlms.h   October 17, 2026
+/***********************************************************************
+	Normalised LMS adaptive noise canceller. The reference input
+	carries the noise alone, and the primary input carries the signal
+	plus that noise as it reaches the primary sensor through an unknown
+	path. An FIR filter of the last taps reference samples models the
+	path. Its output is the noise estimate, which is subtracted from the
+	primary, and the difference is both the canceller's output and the
+	error the weights adapt on:
+
+	  e = d - w.x    w += mu e x / (eps + x.x)
+
+	mu sets the speed of adaptation against the misadjustment left
+	after it converges, and anything in 0 < mu < 2 is stable. The
+	reference history is a Ring, and the filter and the update run
+	straight over its spans. x.x is kept as an exact running sum.
+
+	nlms_run() is float, on the VFP. nlms_run_q15() takes Q15 samples,
+	keeps the weights in Q28 and accumulates in 64 bits. It normalises
+	by the power of two just above eps + x.x instead of dividing, as the
+	ARM1176 has no divide, so its effective step is between mu/2 and mu.
+	Its weights saturate at +-8, so a noise path with more gain than
+	that is only partly cancelled.
+	Either side keeps its own weights, so a canceller is run through
+	one of them only.
+***********************************************************************/
+#ifndef NLMS_H
+#define NLMS_H
+
+#include "fixed.h"
+#include "ring.h"
+
+#define NLMS_MAX_TAPS	64			// power of two, the history ring
+
+typedef struct {
+	int taps;
+	float mu;
+	float eps;
+	int32_t mu_q15;
+	float w[NLMS_MAX_TAPS];			// oldest reference sample first
+	int32_t w_q28[NLMS_MAX_TAPS];
+	int16_t history[NLMS_MAX_TAPS];
+	Ring ring;						// over history
+	int64_t power;					// of the last taps reference samples
+} Nlms;
+
+int   nlms_init(Nlms* f, int taps, float mu, float eps);
+void  nlms_reset(Nlms* f);
+float nlms_run(Nlms* f, q15_t reference, q15_t primary);
+q15_t nlms_run_q15(Nlms* f, q15_t reference, q15_t primary);
+
+#endif /* NLMS_H */
@@ -28,30 +28,42 @@
  
 ***********************************************************************/
 #include "peripheral.h"
-
-volatile unsigned long * p_IRQ = (unsigned long *) p_base_IRQ;
-volatile unsigned long * p_GPIO = (unsigned long *) p_base_GPIO;
-volatile unsigned long * p_TIMER = (unsigned long *) p_base_TIMER;
+#include "hal.h"
 
 //---------------------------------------------------------------------------
 int gpioMODE(unsigned int pin, unsigned int mode) {	//Set GPIO MODE
 //---------------------------------------------------------------------------
-	*(p_GPIO + (pin/10)) &= ~(7 << ((pin%10)*3));
-	*(p_GPIO + (pin/10)) |= (mode << ((pin%10)*3));
+	unsigned int fsel = GPFSEL0 + (pin/10)*4;
+	unsigned int ra = GET32(fsel);
+	ra &= ~(7 << ((pin%10)*3));
+	ra |= (mode << ((pin%10)*3));
+	PUT32(fsel, ra);
 return 0;
 }
 
 //---------------------------------------------------------------------------
 void gpioWR(unsigned int pin, unsigned int state) { //Write to a GPIO pin
 //---------------------------------------------------------------------------
-	if(state==1) *(p_GPIO + 7) = (1 << pin);
-	else   *(p_GPIO + 10) = (1 << pin);
+	if(state==1) PUT32(GPSET0, 1 << pin);
+	else   PUT32(GPCLR0, 1 << pin);
+}
+
+//---------------------------------------------------------------------------
+void gpioSET(unsigned int mask) { //Drive several GPIO pins high at once
+//---------------------------------------------------------------------------
+	PUT32(GPSET0, mask);
+}
+
+//---------------------------------------------------------------------------
+void gpioCLR(unsigned int mask) { //Drive several GPIO pins low at once
+//---------------------------------------------------------------------------
+	PUT32(GPCLR0, mask);
 }
 
 //---------------------------------------------------------------------------
 unsigned int gpioRD(unsigned int pin) { //Read from a GPIO pin
 //---------------------------------------------------------------------------
-	return ((*(p_GPIO + 13) >> pin) & 1);
+	return ((GET32(GPLEV0) >> pin) & 1);
 }
 
 /*
@@ -79,11 +91,11 @@ void delay_us(int us) {
 //---------------------------------------------------------------------------
 unsigned int gpioPUD(unsigned int pin, unsigned char PUDstate) {
 //---------------------------------------------------------------------------
-   *(p_GPIO + 37) = PUDstate;
-   *(p_GPIO + 38) |= (1 << pin);
+   PUT32(GPPUD, PUDstate);
+   PUT32(GPPUDCLK0, GET32(GPPUDCLK0) | (1 << pin));
 //   delay_us(1);
-   *(p_GPIO + 37) = 0;
-   *(p_GPIO + 38) &= ~(1 << pin);
+   PUT32(GPPUD, 0);
+   PUT32(GPPUDCLK0, GET32(GPPUDCLK0) & ~(1 << pin));
    return 0;
 }
 
@@ -92,22 +104,20 @@ unsigned int checkPinEvent(unsigned int pin) {
 //---------------------------------------------------------------------------
   //uses GPEDSn registers to detect whether an event of a defined type
   //has occured.
-  volatile unsigned long  *tmpGPIO;
+  unsigned int tmpGPIO;
   unsigned int pinState = 0;
 
-  tmpGPIO = p_GPIO;
-
   if( pin >= 32 ) {
-   tmpGPIO += GPEDS1;
+   tmpGPIO = GPEDS1;
    pin -=32; //Get pin number for second word.
  }
  else
-   tmpGPIO += GPEDS0;
+   tmpGPIO = GPEDS0;
 
 //Save the bit, write to the register to clear it,
 //then return the saved register.
-   pinState = (( *tmpGPIO >> pin) & 1);
-   *tmpGPIO |= ( 1 << pin ); //write high to clear the event.
+   pinState = (( GET32(tmpGPIO) >> pin) & 1);
+   PUT32(tmpGPIO, 1 << pin); //write high to clear the event.
 
    return pinState;
  //return ( ( *tmpGPIO >> pin ) & 1 );
@@ -126,12 +136,10 @@ unsigned int setPinEvent(unsigned int pin, unsigned int eventType) {
    //perform operation.
 
    //^^^That should yield the simplest code.
-   volatile unsigned long  *tmpGPIO;
+   unsigned int tmpGPIO = 0;
    unsigned int regBank = 0;
    //bool pinState = 0;
 
-   tmpGPIO = p_GPIO;
-
    if(pin > 53)
     return HIGH; //Pin out of bounds.
 
@@ -149,36 +157,35 @@ unsigned int setPinEvent(unsigned int pin, unsigned int eventType) {
 
    switch (eventType) {
      case REN: {
-       tmpGPIO += GPREN0;
+       tmpGPIO = GPREN0;
        break;
      }
      case FEN: {
-       tmpGPIO += GPFEN0;
+       tmpGPIO = GPFEN0;
        break;
      }
      case HEN: {
-       tmpGPIO += GPHEN0;
+       tmpGPIO = GPHEN0;
        break;
      }
      case LEN: {
-       tmpGPIO += GPLEN0;
+       tmpGPIO = GPLEN0;
        break;
      }
      case AREN: {
-       tmpGPIO += GPAREN0;
+       tmpGPIO = GPAREN0;
        break;
      }
      case AFEN: {
-       tmpGPIO += GPAFEN0;
+       tmpGPIO = GPAFEN0;
        break;
      }
      default: {
-       break;
+       return HIGH; //unknown event type.
      }
-
-     tmpGPIO +=  regBank; //adds 0 or 1 for register bank.
    };// end switch()
-   *tmpGPIO |= ( 1 << pin ); //set the register.
+   tmpGPIO += regBank*4; //adds 0 or 1 register for the bank.
+   PUT32(tmpGPIO, GET32(tmpGPIO) | (1 << pin)); //set the register.
   return LOW;
 }
 
@@ -188,7 +195,7 @@ unsigned int peekGPIO(unsigned int addr) { //32
     if (addr >= 0xFFF)
         return 0;
 
-    return *(p_GPIO + addr);
+    return GET32(p_base_GPIO + addr*4);
 }
 
 //---------------------------------------------------------------------------
@@ -197,7 +204,7 @@ unsigned int pokeGPIO(unsigned int addr, unsigned int val) { //32 BIT POKE
     if(addr >= 0xFFF)
         return 1;
 
-    *(p_GPIO + addr) = val;
+    PUT32(p_base_GPIO + addr*4, val);
 
     return 0;
 }
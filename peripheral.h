@@ -1,6 +1,9 @@
 /**********************************************************************/
 //	peripheral.h   September 25, 2018
 /**********************************************************************/
+#ifndef PERIPHERAL_H
+#define PERIPHERAL_H
+
 //address defines
 #define p_base_IRQ    0x2000B200
 #define p_base_GPIO   0x20200000
@@ -105,12 +108,42 @@
 #define SPI_CS	 0x20204000
 #define SPI_FIFO 0x20204004
 #define SPI_CLK  0x20204008
+#define SPI_DLEN 0x2020400C
+
+//DMA physical addresses, channel n registers at DMA_CHAN(n) + offset
+#define DMA_CHAN(n)		(0x20007000 + ((n) << 8))
+#define DMA_CS			0x00
+#define DMA_CONBLK_AD	0x04
+#define DMA_DEBUG		0x20
+#define DMA_INT_STATUS	0x20007FE0
+#define DMA_ENABLE		0x20007FF0
+
+//EMMC (SD card) physical addresses
+#define EMMC_ARG2		0x20300000
+#define EMMC_BLKSIZECNT	0x20300004
+#define EMMC_ARG1		0x20300008
+#define EMMC_CMDTM		0x2030000C
+#define EMMC_RESP0		0x20300010
+#define EMMC_RESP1		0x20300014
+#define EMMC_RESP2		0x20300018
+#define EMMC_RESP3		0x2030001C
+#define EMMC_DATA		0x20300020
+#define EMMC_STATUS		0x20300024
+#define EMMC_CONTROL0	0x20300028
+#define EMMC_CONTROL1	0x2030002C
+#define EMMC_INTERRUPT	0x20300030
+#define EMMC_IRPT_MASK	0x20300034
+#define EMMC_IRPT_EN	0x20300038
+#define EMMC_CONTROL2	0x2030003C
+
+//peripheral addresses as seen from the VC bus, used by DMA
+#define BUS_PERIPHERAL(a)	((a) - 0x20000000 + 0x7E000000)
 
 //IRQ physical addresses
 #define IRQ_BASIC 		  0x2000B200
 #define IRQ_PEND1 		  0x2000B204
 #define IRQ_PEND2 		  0x2000B208
-#define IRQ_FIQ_CONTROL   0x2000B210
+#define IRQ_FIQ_CONTROL   0x2000B20C
 #define IRQ_ENABLE1 	  0x2000B210
 #define IRQ_ENABLE2 	  0x2000B214
 #define IRQ_ENABLE_BASIC  0x2000B218
@@ -118,6 +151,10 @@
 #define IRQ_DISABLE2	  0x2000B220
 #define IRQ_DISABLE_BASIC 0x2000B224
 
+//IRQ_FIQ_CONTROL, enable bit over the source number, 0-63 for the
+//IRQ_PEND1/2 bits
+#define FIQ_ENABLE		  0x80
+
 // pin states
 #define LOW  0
 #define HIGH 1
@@ -149,6 +186,13 @@ This function does not change the pin mode.
 ***********************************************************************/
 unsigned int gpioRD(unsigned int pin);
 
+/***********************************************************************
+Drive every pin set in mask HIGH (gpioSET) or LOW (gpioCLR) with a
+single register write. Pins 0 to 31 only.
+***********************************************************************/
+void gpioSET(unsigned int mask);
+void gpioCLR(unsigned int mask);
+
 unsigned int setPUD(unsigned int pin, unsigned char PUDState);
 /*
 Sets pullup on pins to up, down or off with PUDOFF, PUDDOWN and PUDUP
@@ -176,3 +220,4 @@ returns a high state if pin number is out of bounds.
 The event triggers are checked with checkPinEvent
 */
 
+#endif /* PERIPHERAL_H */
@@ -0,0 +1,125 @@
+/**********************************************************************/
+//	pipeline.c   October 17, 2026
+/***********************************************************************
+	Stage scheduling and decimators, see pipeline.h.
+
+	Two stages with dividers a and b and phases pa and pb meet on some
+	tick exactly when pa and pb agree modulo gcd(a, b). pipeline_add()
+	counts those meetings for every phase the new stage could take and
+	keeps the first phase with the fewest. That runs once per stage at
+	init, so its remainders are done by subtraction.
+***********************************************************************/
+#include "pipeline.h"
+#include "profile.h"
+
+static unsigned int gcd(unsigned int a, unsigned int b) {
+	while(a != b) {
+		if(a > b) a -= b;
+		else b -= a;
+	}
+	return a;
+}
+
+// whether a and b are equal modulo m, fine for the small a and b here
+static unsigned int congruent(unsigned int a, unsigned int b, unsigned int m) {
+	unsigned int d = a > b ? a - b : b - a;
+	while(d >= m) d -= m;
+	return d == 0;
+}
+
+//----------------------------------------------------------------------
+void pipeline_init(Pipeline* p) {
+	p->stages = 0;
+	p->tick = 0;
+}
+
+// adds a stage and picks its phase, returns its index or -1 when full
+int pipeline_add(Pipeline* p, const char* name, unsigned int divider,
+	void (*run)(void), int profile) {
+	if(p->stages == PIPELINE_MAX_STAGES || divider == 0) return -1;
+
+	unsigned int best = 0, best_meets = ~0u;
+	for(unsigned int phase = 0; phase < divider && best_meets; ++phase) {
+		unsigned int meets = 0;
+		for(int ix = 0; ix < p->stages; ++ix) {
+			const PipelineStage* s = &p->stage[ix];
+			if(congruent(phase, s->phase, gcd(divider, s->divider))) ++meets;
+		}
+		if(meets < best_meets) {
+			best = phase;
+			best_meets = meets;
+		}
+	}
+
+	PipelineStage* s = &p->stage[p->stages];
+	s->name = name;
+	s->run = run;
+	s->divider = divider;
+	s->phase = best;
+	s->countdown = best + 1;		//the pipeline starts at tick 0
+	s->profile = profile;
+	return p->stages++;
+}
+
+// whether the stage comes up on the tick the next pipeline_run() runs
+int pipeline_due(const Pipeline* p, int stage) {
+	return p->stage[stage].countdown == 1;
+}
+
+void pipeline_run(Pipeline* p) {
+	PROFILE_START();
+	for(int ix = 0; ix < p->stages; ++ix) {
+		PipelineStage* s = &p->stage[ix];
+		if(--s->countdown) continue;
+		s->countdown = s->divider;
+		if(!s->run) continue;
+		s->run();
+		PROFILE_STAGE(s->profile);
+	}
+	p->tick++;
+}
+
+// the most stages due on any one of the next ticks, without running them
+int pipeline_busiest(const Pipeline* p, unsigned int ticks) {
+	unsigned int countdown[PIPELINE_MAX_STAGES];
+	int busiest = 0;
+
+	for(int ix = 0; ix < p->stages; ++ix) countdown[ix] = p->stage[ix].countdown;
+	for(unsigned int tick = 0; tick < ticks; ++tick) {
+		int due = 0;
+		for(int ix = 0; ix < p->stages; ++ix) {
+			if(--countdown[ix]) continue;
+			countdown[ix] = p->stage[ix].divider;
+			++due;
+		}
+		if(due > busiest) busiest = due;
+	}
+	return busiest;
+}
+
+//----------------------------------------------------------------------
+//	decimators
+//----------------------------------------------------------------------
+void decimator_init(Decimator* d, int factor, DecimateMode mode) {
+	d->factor = factor;
+	d->mode = mode;
+	d->count = 0;
+	d->scale = 1.0f / factor;
+	d->acc = 0;
+	d->out = 0;
+}
+
+// returns 1 when x completed a block and out holds its result
+int decimator_push(Decimator* d, int x) {
+	if(d->mode == DECIMATE_MAX) {
+		if(d->count == 0 || x > d->acc) d->acc = x;
+	} else {
+		d->acc += x;
+	}
+	if(++d->count < d->factor) return 0;
+
+	d->out = (int)(d->mode == DECIMATE_MAX ? d->acc : d->acc * d->scale);
+	d->count = 0;
+	d->acc = 0;
+	return 1;
+}
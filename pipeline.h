@@ -0,0 +1,60 @@
+/**********************************************************************/
+//	pipeline.h   October 17, 2026
+/***********************************************************************
+	Multi-rate stages under the 800 Hz timer tick. Each stage declares
+	its rate as a divider of the tick, and pipeline_add() gives it the
+	phase that collides least with the stages already added, so slow
+	stages land on different ticks rather than piling onto one.
+	pipeline_run() is called once per tick and runs whatever is due.
+
+	Decimators sit between rates. A stage running every Nth tick reads
+	the output of a decimator by N fed at the tick rate, either the
+	mean or the peak of the last N samples.
+
+	Counters only count down, the ARM1176 has no divide instruction.
+***********************************************************************/
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#define PIPELINE_MAX_STAGES	8
+
+typedef struct {
+	const char* name;
+	void (*run)(void);		// may be 0, for a stage something else polls
+	unsigned int divider;	// runs every divider-th tick
+	unsigned int phase;		// on ticks where tick % divider == phase
+	unsigned int countdown;	// ticks until it is due, 1 when due now
+	int profile;			// ProfileStage it is charged to
+} PipelineStage;
+
+typedef struct {
+	PipelineStage stage[PIPELINE_MAX_STAGES];
+	int stages;
+	unsigned int tick;
+} Pipeline;
+
+typedef enum {
+	DECIMATE_MEAN,
+	DECIMATE_MAX
+} DecimateMode;
+
+typedef struct {
+	int factor;
+	DecimateMode mode;
+	int count;
+	float scale;			// 1 / factor
+	float acc;
+	int out;				// last full block
+} Decimator;
+
+void pipeline_init(Pipeline* p);
+int  pipeline_add(Pipeline* p, const char* name, unsigned int divider,
+	void (*run)(void), int profile);
+int  pipeline_due(const Pipeline* p, int stage);
+void pipeline_run(Pipeline* p);
+int  pipeline_busiest(const Pipeline* p, unsigned int ticks);
+
+void decimator_init(Decimator* d, int factor, DecimateMode mode);
+int  decimator_push(Decimator* d, int x);
+
+#endif /* PIPELINE_H */
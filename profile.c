@@ -0,0 +1,88 @@
+/**********************************************************************/
+//	profile.c   October 17, 2026
+/***********************************************************************
+	Stage statistics for PROFILE builds, see profile.h. Each stage is
+	written either by the ISR or by one foreground task, never both.
+	Readers in the _main_ loop copy a stage with the IRQ and FIQ masked
+	so they never see a half updated record.
+***********************************************************************/
+#ifdef PROFILE
+#include "profile.h"
+#include "uart.h"
+#include "library.h"
+#include "hal.h"
+
+static ProfileStat stats[PROFILE_STAGES];
+
+static const char* const names[PROFILE_STAGES] = {
+	"button", "microphones", "cuff", "filter", "cancel", "product", "ring",
+	"detect", "deviation", "pressure", "telemetry", "display", "log",
+	"spectrum"
+};
+
+//----------------------------------------------------------------------
+void profile_record(ProfileStage stage, unsigned int cycles) {
+	ProfileStat* s = &stats[stage];
+	int bin = cycles ? 32 - __builtin_clz(cycles) : 0;
+
+	if(s->count == 0 || cycles < s->min) s->min = cycles;
+	if(cycles > s->max) s->max = cycles;
+	s->total += cycles;
+	s->count++;
+	s->histogram[bin < PROFILE_BINS ? bin : PROFILE_BINS - 1]++;
+}
+
+void profile_reset(void) {
+	disable_irq();
+	memset(stats, 0, sizeof(stats));
+	enable_irq();
+}
+
+// copies a stage out, returns its sample count
+int profile_read(ProfileStage stage, ProfileStat* stat) {
+	disable_irq();
+	*stat = stats[stage];
+	enable_irq();
+	return stat->count;
+}
+
+const char* profile_name(ProfileStage stage) {
+	return names[stage];
+}
+
+//----------------------------------------------------------------------
+//	text report over the UART, one line per stage followed by its
+//	non-empty histogram bins, <2^n:count and >=2^n:count for the last
+//----------------------------------------------------------------------
+void profile_report(void) {
+	char line[24 * PROFILE_BINS];
+	ProfileStat s;
+
+	for(int ix = 0; ix < PROFILE_STAGES; ++ix) {
+		if(!profile_read(ix, &s)) continue;
+
+		char* p = put_str(line, names[ix]);
+		p = put_str(p, " n ");
+		p = put_uint(p, s.count);
+		p = put_str(p, " min ");
+		p = put_uint(p, s.min);
+		p = put_str(p, " avg ");
+		p = put_uint(p, (unsigned int)(s.total / s.count));
+		p = put_str(p, " max ");
+		p = put_uint(p, s.max);
+		p = put_str(p, "\r\n");
+		uart_put_line(line, p);
+
+		p = put_str(line, " ");
+		for(int bin = 0; bin < PROFILE_BINS; ++bin) {
+			if(!s.histogram[bin]) continue;
+			p = put_str(p, bin == PROFILE_BINS - 1 ? " >=" : " <");
+			p = put_uint(p, bin == PROFILE_BINS - 1 ? 1u << (bin - 1) : 1u << bin);
+			p = put_str(p, ":");
+			p = put_uint(p, s.histogram[bin]);
+		}
+		p = put_str(p, "\r\n");
+		uart_put_line(line, p);
+	}
+}
+#endif
@@ -0,0 +1,67 @@
+/**********************************************************************/
+//	profile.h   October 17, 2026
+/***********************************************************************
+	Per-stage cycle profiling of the tick's work. PROFILE_START()
+	stamps hal_cycles() on entry and each PROFILE_STAGE() charges the
+	cycles since the previous stamp to its stage, keeping the count,
+	min, max, total and a log2 histogram. Build with make PROFILE=1,
+	otherwise the macros compile to nothing. The counts are CCNT cycles
+	on the Pi Zero and nanoseconds on the host. Stages timed in the
+	foreground tasks also take in any interrupt that lands inside them.
+***********************************************************************/
+#ifndef PROFILE_H
+#define PROFILE_H
+
+typedef enum {
+	PROFILE_BUTTON,			// latching push button
+	PROFILE_MICROPHONES,	// spi_microphones, or acquire_flip with DMA
+	PROFILE_CUFF,			// spi_cuff_pressure, every 80th tick
+	PROFILE_FILTER,			// biquad band-pass of both microphones
+	PROFILE_CANCEL,			// nlms_run, NOISE_CANCEL builds
+	PROFILE_PRODUCT,		// process_microphones
+	PROFILE_RING,			// WriteToRingBuffer
+	PROFILE_DETECT,			// ZScoreUpdate
+	PROFILE_DEVIATION,		// DetermineDeviation
+	PROFILE_PRESSURE,		// bp_update
+	PROFILE_TELEMETRY,		// telemetry_sample
+	PROFILE_DISPLAY,		// display_task, every 400th tick
+	PROFILE_LOG,			// sdlog_service, SD card writes
+	PROFILE_SPECTRUM,		// one microphone's FFT and magnitudes
+	PROFILE_STAGES
+} ProfileStage;
+
+// bin 0 counts 0 cycles, bin n counts 2^(n-1) to 2^n - 1 and the last
+// bin everything from 2^(PROFILE_BINS-2) up
+#define PROFILE_BINS	20
+
+typedef struct {
+	unsigned int count;
+	unsigned int min;
+	unsigned int max;
+	unsigned long long total;
+	unsigned int histogram[PROFILE_BINS];
+} ProfileStat;
+
+#ifdef PROFILE
+#include "hal.h"
+
+#define PROFILE_START()		unsigned int profile_mark = hal_cycles()
+#define PROFILE_STAGE(stage)	do { \
+		unsigned int profile_now = hal_cycles(); \
+		profile_record(stage, profile_now - profile_mark); \
+		profile_mark = profile_now; \
+	} while(0)
+#define PROFILE_RESUME()	profile_mark = hal_cycles()	// skip a callee's own stages
+
+void profile_record(ProfileStage stage, unsigned int cycles);
+void profile_reset(void);
+int  profile_read(ProfileStage stage, ProfileStat* stat);
+const char* profile_name(ProfileStage stage);
+void profile_report(void);
+#else
+#define PROFILE_START()
+#define PROFILE_STAGE(stage)
+#define PROFILE_RESUME()
+#endif
+
+#endif /* PROFILE_H */
@@ -0,0 +1,304 @@
+/**********************************************************************/
+//	replay.c   October 17, 2026
+/***********************************************************************
+	Runs recorded microphone and cuff samples through signal_step(),
+	the same process_microphones, WriteToRingBuffer, ZScoreUpdate and
+	DetermineDeviation path the signal task runs on each tick the ISR
+	acquired, as fast as it will go.
+	The cuff pressure and the deviation, decimated to its peak over
+	every ENVELOPE_DECIMATE samples, feed bp_update() as they do on the
+	board, and every blood pressure estimate is listed at the end.
+	The NLMS canceller also runs over the raw microphones on its own,
+	mic_two as the noise reference for mic_one, and the share of
+	mic_one's power it removed is reported, and each microphone's mean
+	and deviation over the whole recording come from stats_s16(), the
+	widest kernel the host build allows.
+
+	A recording is either a telemetry capture from the board or
+	bpsure_host, recognised by its 0x00 frame delimiters, an SD card
+	image holding a session log (sdlog.h), recognised by its MBR and log
+	partition, of which the last session is replayed, or text with one
+	"mic_one mic_two [cuff]" sample per line, where # starts a comment.
+	The whole recording is loaded before the clock starts, so the
+	samples/s figure is the signal path alone.
+
+	The output has one line per sample:
+	  index mic_one mic_two cuff product deviation signal
+
+	usage: bpsure_replay recording [output.txt]
+	       the per-sample output is skipped without an output file
+***********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal.h"
+#include "kernel.h"
+#include "telemetry.h"
+#include "sdlog.h"
+#include "sdcard.h"
+#include "nlms.h"
+#include "stats.h"
+#include "bp.h"
+
+typedef struct {
+	short mic_one;
+	short mic_two;
+	int cuff;
+} Sample;
+
+static Sample* samples = 0;
+static unsigned int count = 0, capacity = 0;
+static unsigned int crc_errors = 0, bad_lines = 0;
+static unsigned int log_session = 0, log_lost = 0;
+
+enum { RECORDING_TEXT, RECORDING_CAPTURE, RECORDING_SDLOG };
+
+#define MAX_ESTIMATES	64
+
+typedef struct {
+	unsigned int index;		// sample that finished the deflation
+	PulseInfo bp;
+} Estimate;
+
+static void append(int mic_one, int mic_two, int cuff) {
+	if(count == capacity) {
+		capacity = capacity ? capacity * 2 : 4096;
+		samples = realloc(samples, capacity * sizeof(Sample));
+		if(!samples) {
+			fprintf(stderr, "out of memory at %u samples\n", count);
+			exit(1);
+		}
+	}
+	samples[count].mic_one = (short)mic_one;
+	samples[count].mic_two = (short)mic_two;
+	samples[count].cuff = cuff;
+	count++;
+}
+
+//----------------------------------------------------------------------
+//	recording readers
+//----------------------------------------------------------------------
+static void read_capture(const unsigned char* data, long size) {
+	TelemetrySample s;
+	unsigned short seq;
+	long start = 0;
+
+	for(long ix = 0; ix < size; ++ix) {
+		if(data[ix] != 0) continue;
+		int len = (int)(ix - start);
+		if(len > 0) {
+			int result = telemetry_decode(data + start, len, &s, &seq);
+			if(result == 0) append(s.mic_one, s.mic_two, s.cuff);
+			else crc_errors++;
+		}
+		start = ix + 1;
+	}
+}
+
+static unsigned int le32(const unsigned char* p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+// the log partition's first block in the image, or 0 when there is none
+static long sdlog_partition(const unsigned char* data, long size) {
+	if(size < 2 * SD_BLOCK || data[510] != 0x55 || data[511] != 0xAA) return 0;
+	for(int ix = 0; ix < 4; ++ix) {
+		const unsigned char* entry = data + 446 + 16 * ix;
+		if(entry[4] != SDLOG_PARTITION) continue;
+		long first = le32(entry + 8);
+		if(first < 1 || (first + 1) * SD_BLOCK > size) return 0;
+		const SdLogBlock* super = (const SdLogBlock*)(data + first * SD_BLOCK);
+		return sdlog_valid(super) && super->header.magic == SDLOG_SUPER ? first : 0;
+	}
+	return 0;
+}
+
+// the blocks written since the last format, keeping the last session
+static void read_sdlog(const unsigned char* data, long size, long first) {
+	const SdLogBlock* block = (const SdLogBlock*)(data + first * SD_BLOCK);
+	unsigned int epoch = block->header.epoch;
+
+	for(unsigned int sequence = 1; (first + sequence + 1) * SD_BLOCK <= size; ++sequence) {
+		const SdLogBlock* b = &block[sequence];
+		if(!sdlog_valid(b) || b->header.magic != SDLOG_DATA ||
+			b->header.epoch != epoch || b->header.sequence != sequence) break;
+		if(b->header.session != log_session) {
+			log_session = b->header.session;
+			log_lost = 0;
+			count = 0;
+		}
+		log_lost += b->header.lost;
+		for(unsigned int ix = 0; ix < b->header.count && ix < SDLOG_RECORDS; ++ix)
+			append(b->record[ix].mic_one, b->record[ix].mic_two, b->record[ix].cuff);
+	}
+}
+
+static void read_text(char* text, long size) {
+	char* line = text;
+
+	text[size] = '\0';
+	while(*line) {
+		char* end = line;
+		while(*end && *end != '\n') ++end;
+		char next = *end;
+		*end = '\0';
+
+		int mic_one, mic_two, cuff = 0;
+		char* hash = line;
+		while(*hash && *hash != '#') ++hash;
+		*hash = '\0';
+		int fields = sscanf(line, "%d %d %d", &mic_one, &mic_two, &cuff);
+		if(fields >= 2) append(mic_one, mic_two, cuff);
+		else if(fields != EOF) bad_lines++;
+
+		line = next ? end + 1 : end;
+	}
+}
+
+static int load(const char* name) {
+	FILE* in = fopen(name, "rb");
+	if(!in) {
+		perror(name);
+		return -1;
+	}
+	fseek(in, 0, SEEK_END);
+	long size = ftell(in);
+	fseek(in, 0, SEEK_SET);
+
+	unsigned char* data = malloc(size + 1);
+	if(!data || fread(data, 1, size, in) != (size_t)size) {
+		fprintf(stderr, "%s: read failed\n", name);
+		fclose(in);
+		return -1;
+	}
+	fclose(in);
+
+	int kind = RECORDING_TEXT;
+	long first = sdlog_partition(data, size);
+	for(long ix = 0; ix < size && !kind; ++ix)
+		if(data[ix] == 0) kind = RECORDING_CAPTURE;
+	if(first) {
+		kind = RECORDING_SDLOG;
+		read_sdlog(data, size, first);
+	} else if(kind == RECORDING_CAPTURE) read_capture(data, size);
+	else read_text((char*)data, size);
+	free(data);
+	return kind;
+}
+
+//----------------------------------------------------------------------
+int main(int argc, char** argv) {
+	if(argc < 2) {
+		fprintf(stderr, "usage: bpsure_replay recording [output.txt]\n");
+		return 1;
+	}
+	int kind = load(argv[1]);
+	if(kind < 0) return 1;
+
+	SignalOutput* out = malloc((count ? count : 1) * sizeof(SignalOutput));
+	if(!out) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	static BpEngine bp;
+	static Estimate estimates[MAX_ESTIMATES];
+	unsigned int estimated = 0, failed = 0;
+	Decimator envelope;
+	BpConfig config;
+	bp_default_config(&config);
+	config.rate_hz = SAMPLE_HZ / ENVELOPE_DECIMATE;
+	bp_init(&bp, &config);
+	decimator_init(&envelope, ENVELOPE_DECIMATE, DECIMATE_MAX);
+
+	signal_init();
+	unsigned long long start = hal_host_nanos();
+	for(unsigned int ix = 0; ix < count; ++ix) {
+		signal_step(samples[ix].mic_one, samples[ix].mic_two, &out[ix]);
+		if(!decimator_push(&envelope, out[ix].deviation)) continue;
+		BpState was = bp.state;
+		BpState state = bp_update(&bp, samples[ix].cuff, envelope.out);
+		if(state == was) continue;
+		if(state == BP_FAILED) failed++;
+		if(state == BP_DONE && estimated < MAX_ESTIMATES) {
+			estimates[estimated].index = ix;
+			bp_result(&bp, &estimates[estimated++].bp);
+		}
+	}
+	unsigned long long elapsed = hal_host_nanos() - start;
+
+	// whatever of mic_one the reference predicts counts as removed
+	static Nlms canceller;
+	double in_power = 0, out_power = 0;
+	nlms_init(&canceller, CANCEL_TAPS, CANCEL_MU, CANCEL_EPS);
+	unsigned long long cancel_start = hal_host_nanos();
+	for(unsigned int ix = 0; ix < count; ++ix) {
+#ifdef FIXED_DSP
+		double e = nlms_run_q15(&canceller, samples[ix].mic_two, samples[ix].mic_one);
+#else
+		double e = nlms_run(&canceller, samples[ix].mic_two, samples[ix].mic_one);
+#endif
+		in_power += (double)samples[ix].mic_one * samples[ix].mic_one;
+		out_power += e * e;
+	}
+	unsigned long long cancel_elapsed = hal_host_nanos() - cancel_start;
+
+	// the microphones as int16 windows for the statistics kernels, in
+	// pieces short enough for their sums to stay exact
+	WindowStats level[2] = { { 0 } }, part;
+	int16_t* mic = malloc(count * sizeof(int16_t) + 1);
+	if(!mic) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	for(int jx = 0; jx < 2; ++jx) {
+		for(unsigned int ix = 0; ix < count; ++ix)
+			mic[ix] = jx ? samples[ix].mic_two : samples[ix].mic_one;
+		for(unsigned int ix = 0; ix < count; ix += STATS_MAX_WINDOW - 1) {
+			unsigned int n = count - ix < STATS_MAX_WINDOW - 1 ? count - ix : STATS_MAX_WINDOW - 1;
+			stats_s16(mic + ix, n, &part);
+			level[jx].sum += part.sum;
+			level[jx].squares += part.squares;
+			level[jx].count += part.count;
+		}
+	}
+	free(mic);
+
+	if(argc > 2) {
+		FILE* file = fopen(argv[2], "w");
+		if(!file) {
+			perror(argv[2]);
+			return 1;
+		}
+		for(unsigned int ix = 0; ix < count; ++ix)
+			fprintf(file, "%u %d %d %d %d %d %d\n", ix, samples[ix].mic_one,
+				samples[ix].mic_two, samples[ix].cuff, out[ix].product,
+				out[ix].deviation, out[ix].signal);
+		fclose(file);
+	}
+
+	static const char* const kinds[] = { "text", "telemetry capture", "sd card log" };
+	printf("replay   %s, %s\n", argv[1], kinds[kind]);
+	printf("  %u samples", count);
+	if(kind == RECORDING_CAPTURE) printf("  %u bad frames", crc_errors);
+	else if(kind == RECORDING_SDLOG) printf("  session %u  %u lost", log_session, log_lost);
+	else printf("  %u bad lines", bad_lines);
+	printf("  %u peaks\n", pulse_count);
+	printf("  %u blood pressure estimates, %u failed\n", estimated, failed);
+	for(unsigned int ix = 0; ix < estimated; ++ix)
+		printf("    sample %u  %d/%d mmHg  MAP %d\n", estimates[ix].index,
+			estimates[ix].bp.sistolic, estimates[ix].bp.diastolic,
+			estimates[ix].bp.mean);
+	if(count)
+		printf("  mic_one mean %.1f dev %.1f, mic_two mean %.1f dev %.1f (%s)\n",
+			stats_mean(&level[0]), stats_deviation(&level[0]),
+			stats_mean(&level[1]), stats_deviation(&level[1]), stats_kernel());
+	if(count && out_power > 0)
+		printf("  canceller %d taps mu %.2f, %.1f dB of mic_one removed  %.1f ns/sample\n",
+			CANCEL_TAPS, CANCEL_MU, 10 * ln((float)(in_power / out_power)) / ln(10),
+			(double)cancel_elapsed / count);
+	if(count && elapsed)
+		printf("  %.1f ns/sample  %.0f samples/s  (%.0fx real time at 800 Hz)\n",
+			(double)elapsed / count, count * 1e9 / elapsed,
+			count * 1e9 / elapsed / 800);
+	return 0;
+}
@@ -0,0 +1,61 @@
+/**********************************************************************/
+//	ring.c   October 17, 2026
+/***********************************************************************
+	Power of two ring, see ring.h. A bulk write or a window covers the
+	storage in at most two pieces, the one before the wrap and the one
+	after it.
+***********************************************************************/
+#include "ring.h"
+#include "library.h"
+
+//----------------------------------------------------------------------
+// 0, or -1 when size is not a power of two
+int ring_init(Ring* r, void* storage, unsigned int size, unsigned int elem) {
+	if(size == 0 || (size & (size - 1)) || elem == 0) return -1;
+	r->data = storage;
+	r->size = size;
+	r->mask = size - 1;
+	r->elem = elem;
+	ring_clear(r);
+	return 0;
+}
+
+void ring_clear(Ring* r) {
+	r->head = 0;
+	memset(r->data, 0, r->size * r->elem);
+}
+
+// appends n elements, only the last size of them are kept
+void ring_write(Ring* r, const void* src, unsigned int n) {
+	const unsigned char* s = src;
+
+	if(n > r->size) {
+		s += (n - r->size) * r->elem;
+		r->head += n - r->size;
+		n = r->size;
+	}
+	unsigned int at = r->head & r->mask;
+	unsigned int first = r->size - at;
+	if(first > n) first = n;
+	memcpy(r->data + at * r->elem, s, first * r->elem);
+	if(n > first) memcpy(r->data, s + first * r->elem, (n - first) * r->elem);
+	r->head += n;
+}
+
+// the last n elements, oldest first, returns the number of spans used
+int ring_window(const Ring* r, unsigned int n, RingSpan span[2]) {
+	if(n > r->size) n = r->size;
+	if(n == 0) return 0;
+
+	unsigned int at = (r->head - n) & r->mask;
+	unsigned int first = r->size - at;
+	span[0].data = r->data + at * r->elem;
+	if(first >= n) {
+		span[0].count = n;
+		return 1;
+	}
+	span[0].count = first;
+	span[1].data = r->data;
+	span[1].count = n - first;
+	return 2;
+}
@@ -0,0 +1,45 @@
+/**********************************************************************/
+//	ring.h   October 17, 2026
+/***********************************************************************
+	Ring of fixed size elements of any type over storage the caller
+	owns, with a power of two length, so positions are masked rather
+	than divided. head counts the elements ever written, free running,
+	and the element written last is at (head - 1) & mask. The storage
+	starts zeroed, so a window is always full, as with RingBuffer.
+
+	ring_window() hands out the last n elements, oldest first, as at
+	most two contiguous spans straight over the storage: the part from
+	the window's start up to the end of the storage, then the part
+	that wrapped to its beginning. A kernel runs over each span in turn
+	without copying and without a call per element.
+
+	A window is only stable while nothing writes to the ring, so it is
+	read by the side that writes it, or with the writer held off.
+***********************************************************************/
+#ifndef RING_H
+#define RING_H
+
+typedef struct {
+	unsigned char* data;
+	unsigned int size;			// elements, a power of two
+	unsigned int mask;
+	unsigned int elem;			// bytes per element
+	unsigned int head;			// elements written, free running
+} Ring;
+
+typedef struct {
+	const void* data;
+	unsigned int count;			// elements
+} RingSpan;
+
+// typed access, position 0 is the oldest element of a full ring
+#define RING_AT(r, type, ix)	(((type*)(r)->data)[((r)->head + (ix)) & (r)->mask])
+#define RING_LAST(r, type)		(((type*)(r)->data)[((r)->head - 1) & (r)->mask])
+#define RING_PUSH(r, type, v)	(((type*)(r)->data)[(r)->head++ & (r)->mask] = (v))
+
+int  ring_init(Ring* r, void* storage, unsigned int size, unsigned int elem);
+void ring_clear(Ring* r);
+void ring_write(Ring* r, const void* src, unsigned int n);
+int  ring_window(const Ring* r, unsigned int n, RingSpan span[2]);
+
+#endif /* RING_H */
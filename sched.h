@@ -0,0 +1,59 @@
+/**********************************************************************/
+//	sched.h   October 17, 2026
+/***********************************************************************
+	Run-to-completion tasks for the _main_ loop. An interrupt handler,
+	or another task, posts a task when it has work for it, and
+	sched_run() runs the most urgent ready task to completion. Urgency
+	is the task's priority first, then the earlier deadline, which is
+	the CLO of its first pending post plus its deadline_us.
+
+	A task posted again before it runs still runs once, so a task that
+	works on queued items drains the whole queue each run. Each task is
+	posted from one side only, its interrupt handler or the foreground,
+	and the ready flags are bytes, so neither side needs the other
+	masked.
+
+	Each task counts its posts, runs and late starts, its latency from
+	first post to dispatch in us and its runtime in hal_cycles() counts.
+***********************************************************************/
+#ifndef SCHED_H
+#define SCHED_H
+
+#define SCHED_MAX_TASKS	8
+
+typedef struct {
+	unsigned int posts;
+	unsigned int runs;
+	unsigned int missed;			// dispatched after the deadline
+	unsigned int latency_max;		// first post to dispatch, us
+	unsigned long long latency_total;
+	unsigned int runtime_max;		// hal_cycles() counts
+	unsigned long long runtime_total;
+} TaskStats;
+
+typedef struct {
+	const char* name;
+	void (*run)(void);
+	int priority;					// higher runs first
+	unsigned int deadline_us;		// first post to dispatch
+	volatile unsigned char ready;
+	volatile unsigned int posted;	// CLO of the first pending post
+	TaskStats stats;
+} Task;
+
+typedef struct {
+	Task task[SCHED_MAX_TASKS];
+	int tasks;
+	unsigned int idle;				// sched_run() calls with nothing ready
+} Scheduler;
+
+void sched_init(Scheduler* s);
+int  sched_add(Scheduler* s, const char* name, void (*run)(void),
+	int priority, unsigned int deadline_us);
+void sched_post(Scheduler* s, int task);
+int  sched_run(Scheduler* s);
+void sched_read(Scheduler* s, int task, TaskStats* stats);
+void sched_reset(Scheduler* s);
+void sched_report(Scheduler* s);
+
+#endif /* SCHED_H */
@@ -0,0 +1,253 @@
+/**********************************************************************/
+//	sdcard.c   October 17, 2026
+/***********************************************************************
+	SD card driver, see sdcard.h. The GPU firmware boots from the same
+	card and leaves GPIO48-53 on the EMMC controller, so only the
+	controller and the card are set up here.
+
+	The EMMC base clock is taken to be 250MHz. On a 200MHz base the
+	dividers below give 320kHz and 20MHz, still inside the limits.
+	Every wait is bounded by a CLO timeout.
+***********************************************************************/
+#include "sdcard.h"
+#include "peripheral.h"
+#include "hal.h"
+
+#define SD_BASE_HZ		250000000
+#define DIVIDER(hz)		((SD_BASE_HZ + 2 * (hz) - 1) / (2 * (hz)))
+#define CLOCK_BITS(div)	((((div) & 0xFF) << 8) | ((((div) >> 8) & 3) << 6))
+
+// EMMC_CMDTM
+#define TM_BLKCNT_EN	0x00000002
+#define TM_AUTO_CMD12	0x00000004
+#define TM_READ			0x00000010
+#define TM_MULTI_BLOCK	0x00000020
+#define RSP_NONE		0x00000000
+#define RSP_136			0x00010000
+#define RSP_48			0x00020000
+#define RSP_48_BUSY		0x00030000
+#define CMD_CRCCHK		0x00080000
+#define CMD_IXCHK		0x00100000
+#define CMD_ISDATA		0x00200000
+#define CMD_INDEX(n)	((n) << 24)
+
+#define R1				(RSP_48 | CMD_CRCCHK | CMD_IXCHK)
+#define DATA_READ		(CMD_ISDATA | TM_READ)
+#define DATA_MULTI		(TM_MULTI_BLOCK | TM_BLKCNT_EN | TM_AUTO_CMD12)
+
+#define CMD_GO_IDLE			(CMD_INDEX(0) | RSP_NONE)
+#define CMD_ALL_SEND_CID	(CMD_INDEX(2) | RSP_136 | CMD_CRCCHK)
+#define CMD_SEND_RCA		(CMD_INDEX(3) | R1)
+#define CMD_SELECT			(CMD_INDEX(7) | RSP_48_BUSY | CMD_CRCCHK | CMD_IXCHK)
+#define CMD_SEND_IF_COND	(CMD_INDEX(8) | R1)
+#define CMD_SET_BLOCKLEN	(CMD_INDEX(16) | R1)
+#define CMD_READ_SINGLE		(CMD_INDEX(17) | R1 | DATA_READ)
+#define CMD_READ_MULTI		(CMD_INDEX(18) | R1 | DATA_READ | DATA_MULTI)
+#define CMD_WRITE_SINGLE	(CMD_INDEX(24) | R1 | CMD_ISDATA)
+#define CMD_WRITE_MULTI		(CMD_INDEX(25) | R1 | CMD_ISDATA | DATA_MULTI)
+#define CMD_APP				(CMD_INDEX(55) | R1)
+#define ACMD_SET_BUS_WIDTH	(CMD_INDEX(6) | R1)
+#define ACMD_SEND_OP_COND	(CMD_INDEX(41) | RSP_48)
+
+// EMMC_STATUS
+#define SR_CMD_INHIBIT	0x00000001
+#define SR_DAT_INHIBIT	0x00000002
+
+// EMMC_INTERRUPT
+#define INT_CMD_DONE	0x00000001
+#define INT_DATA_DONE	0x00000002
+#define INT_WRITE_RDY	0x00000010
+#define INT_READ_RDY	0x00000020
+#define INT_ERROR		0x017F8000
+
+// EMMC_CONTROL0 and EMMC_CONTROL1
+#define C0_4BIT			0x00000002
+#define C1_CLK_INTLEN	0x00000001
+#define C1_CLK_STABLE	0x00000002
+#define C1_CLK_EN		0x00000004
+#define C1_TOUNIT_MAX	0x000E0000
+#define C1_SRST_HC		0x01000000
+#define C1_SRST_CMD		0x02000000
+#define C1_SRST_DATA	0x04000000
+
+// OCR, voltage window 2.7-3.6V and the high capacity bits
+#define OCR_VOLTAGE		0x00FF8000
+#define OCR_HCS			0x40000000
+#define OCR_READY		0x80000000
+
+#define CMD_TIMEOUT_US		10000
+#define DATA_TIMEOUT_US		500000
+#define INIT_TIMEOUT_US		1000000
+
+static unsigned int rca = 0;
+static unsigned int block_addressing = 0;	// SDHC/SDXC, otherwise byte addresses
+
+static struct {
+	const unsigned int* data;
+	unsigned int blocks;		// in the transfer, 0 when idle
+	unsigned int moved;			// handed to the controller
+	unsigned int start;			// CLO at sd_write_start()
+} write;
+
+//----------------------------------------------------------------------
+static int timed_out(unsigned int start, unsigned int timeout_us) {
+	return GET32(CLO) - start > timeout_us;
+}
+
+// resets the command and data lines after an error
+static void line_reset(void) {
+	unsigned int start = GET32(CLO);
+	PUT32(EMMC_CONTROL1, GET32(EMMC_CONTROL1) | C1_SRST_CMD | C1_SRST_DATA);
+	while(GET32(EMMC_CONTROL1) & (C1_SRST_CMD | C1_SRST_DATA))
+		if(timed_out(start, CMD_TIMEOUT_US)) break;
+	PUT32(EMMC_INTERRUPT, ~0u);
+}
+
+// waits for every bit in mask and clears them
+static int wait_interrupt(unsigned int mask, unsigned int timeout_us) {
+	unsigned int start = GET32(CLO);
+	for(;;) {
+		unsigned int irq = GET32(EMMC_INTERRUPT);
+		if(irq & INT_ERROR) break;
+		if((irq & mask) == mask) {
+			PUT32(EMMC_INTERRUPT, mask);
+			return SD_OK;
+		}
+		if(timed_out(start, timeout_us)) break;
+	}
+	line_reset();
+	return SD_ERROR;
+}
+
+static int command(unsigned int cmd, unsigned int arg) {
+	unsigned int start = GET32(CLO);
+	while(GET32(EMMC_STATUS) & SR_CMD_INHIBIT)
+		if(timed_out(start, CMD_TIMEOUT_US)) return SD_ERROR;
+	PUT32(EMMC_ARG1, arg);
+	PUT32(EMMC_CMDTM, cmd);
+	return wait_interrupt(INT_CMD_DONE, CMD_TIMEOUT_US);
+}
+
+static int app_command(unsigned int cmd, unsigned int arg) {
+	if(command(CMD_APP, rca)) return SD_ERROR;
+	return command(cmd, arg);
+}
+
+static int set_clock(unsigned int bits) {
+	unsigned int start = GET32(CLO);
+	unsigned int c1 = GET32(EMMC_CONTROL1) & ~(C1_CLK_EN | 0xFFC0);
+	PUT32(EMMC_CONTROL1, c1);
+	PUT32(EMMC_CONTROL1, c1 | C1_CLK_INTLEN | bits);
+	while(!(GET32(EMMC_CONTROL1) & C1_CLK_STABLE))
+		if(timed_out(start, CMD_TIMEOUT_US)) return SD_ERROR;
+	PUT32(EMMC_CONTROL1, GET32(EMMC_CONTROL1) | C1_CLK_EN);
+	return SD_OK;
+}
+
+static unsigned int address(unsigned int lba) {
+	return block_addressing ? lba : lba * SD_BLOCK;
+}
+
+//----------------------------------------------------------------------
+//	identification at 400kHz, then select the card, 4 bit bus, 25MHz
+//----------------------------------------------------------------------
+int sd_init(void) {
+	unsigned int start = GET32(CLO);
+
+	write.blocks = 0;
+	PUT32(EMMC_CONTROL0, 0);
+	PUT32(EMMC_CONTROL1, C1_SRST_HC);
+	while(GET32(EMMC_CONTROL1) & C1_SRST_HC)
+		if(timed_out(start, CMD_TIMEOUT_US)) return SD_ERROR;
+	PUT32(EMMC_CONTROL1, C1_TOUNIT_MAX);
+	if(set_clock(CLOCK_BITS(DIVIDER(400000)))) return SD_ERROR;
+	PUT32(EMMC_IRPT_EN, 0);				//polled, nothing to the ARM
+	PUT32(EMMC_IRPT_MASK, ~0u);
+	PUT32(EMMC_INTERRUPT, ~0u);
+
+	rca = 0;
+	command(CMD_GO_IDLE, 0);
+	if(command(CMD_SEND_IF_COND, 0x1AA)) return SD_ERROR;	//no card, or version 1
+	if((GET32(EMMC_RESP0) & 0xFFF) != 0x1AA) return SD_ERROR;
+
+	start = GET32(CLO);
+	unsigned int ocr;
+	do {
+		if(timed_out(start, INIT_TIMEOUT_US)) return SD_ERROR;
+		if(app_command(ACMD_SEND_OP_COND, OCR_HCS | OCR_VOLTAGE)) return SD_ERROR;
+		ocr = GET32(EMMC_RESP0);
+	} while(!(ocr & OCR_READY));
+	block_addressing = (ocr & OCR_HCS) != 0;
+
+	if(command(CMD_ALL_SEND_CID, 0)) return SD_ERROR;
+	if(command(CMD_SEND_RCA, 0)) return SD_ERROR;
+	rca = GET32(EMMC_RESP0) & 0xFFFF0000;
+	if(command(CMD_SELECT, rca)) return SD_ERROR;
+
+	if(app_command(ACMD_SET_BUS_WIDTH, 2)) return SD_ERROR;
+	PUT32(EMMC_CONTROL0, GET32(EMMC_CONTROL0) | C0_4BIT);
+	if(!block_addressing && command(CMD_SET_BLOCKLEN, SD_BLOCK)) return SD_ERROR;
+	return set_clock(CLOCK_BITS(DIVIDER(25000000)));
+}
+
+//----------------------------------------------------------------------
+int sd_read(unsigned int lba, void* data, unsigned int blocks) {
+	unsigned int* out = data;
+
+	if(write.blocks) return SD_BUSY;
+	if(!blocks) return SD_OK;
+	PUT32(EMMC_BLKSIZECNT, SD_BLOCK | (blocks << 16));
+	if(command(blocks > 1 ? CMD_READ_MULTI : CMD_READ_SINGLE, address(lba)))
+		return SD_ERROR;
+	while(blocks--) {
+		if(wait_interrupt(INT_READ_RDY, DATA_TIMEOUT_US)) return SD_ERROR;
+		for(int ix = 0; ix < SD_BLOCK / 4; ++ix) *out++ = GET32(EMMC_DATA);
+	}
+	return wait_interrupt(INT_DATA_DONE, DATA_TIMEOUT_US);
+}
+
+int sd_write_start(unsigned int lba, const void* data, unsigned int blocks) {
+	if(write.blocks || (GET32(EMMC_STATUS) & SR_DAT_INHIBIT)) return SD_BUSY;
+	if(!blocks) return SD_OK;
+	PUT32(EMMC_BLKSIZECNT, SD_BLOCK | (blocks << 16));
+	if(command(blocks > 1 ? CMD_WRITE_MULTI : CMD_WRITE_SINGLE, address(lba)))
+		return SD_ERROR;
+	write.data = data;
+	write.blocks = blocks;
+	write.moved = 0;
+	write.start = GET32(CLO);
+	return SD_OK;
+}
+
+// at most one block into the controller per call
+int sd_write_poll(void) {
+	if(!write.blocks) return SD_OK;
+
+	unsigned int irq = GET32(EMMC_INTERRUPT);
+	if(!(irq & INT_ERROR) && !timed_out(write.start, DATA_TIMEOUT_US)) {
+		if(write.moved < write.blocks && (irq & INT_WRITE_RDY)) {
+			PUT32(EMMC_INTERRUPT, INT_WRITE_RDY);
+			for(int ix = 0; ix < SD_BLOCK / 4; ++ix) PUT32(EMMC_DATA, *write.data++);
+			write.moved++;
+		}
+		if(!(irq & INT_DATA_DONE)) return SD_BUSY;
+		PUT32(EMMC_INTERRUPT, INT_DATA_DONE);
+		write.blocks = 0;
+		return SD_OK;
+	}
+	write.blocks = 0;
+	line_reset();
+	return SD_ERROR;
+}
+
+// blocking, for the few writes outside of a running session
+int sd_write(unsigned int lba, const void* data, unsigned int blocks) {
+	int status;
+	unsigned int start = GET32(CLO);
+
+	while((status = sd_write_start(lba, data, blocks)) == SD_BUSY)
+		if(timed_out(start, DATA_TIMEOUT_US)) return SD_ERROR;
+	if(status != SD_OK) return status;
+	while((status = sd_write_poll()) == SD_BUSY) continue;
+	return status;
+}
@@ -0,0 +1,32 @@
+/**********************************************************************/
+//	sdcard.h   October 17, 2026
+/***********************************************************************
+	SD card block driver on the BCM2835 EMMC controller, 4 bit bus at
+	up to 25MHz, polled. SD version 2 cards only, SDSC or SDHC/SDXC.
+
+	Reads block the caller until the data is in, they are for mounting.
+	Writes never block. sd_write_start() issues the command and returns,
+	then each sd_write_poll() moves at most one block into the
+	controller and reports SD_BUSY until the card has programmed the
+	last one, so a foreground task can run a transfer across as many
+	calls as it takes. Multi-block writes end with an automatic CMD12.
+
+	Buffers are read and written a word at a time and must be 4 byte
+	aligned.
+***********************************************************************/
+#ifndef SDCARD_H
+#define SDCARD_H
+
+#define SD_BLOCK	512
+
+#define SD_OK		0
+#define SD_BUSY		1
+#define SD_ERROR	(-1)
+
+int sd_init(void);
+int sd_read(unsigned int lba, void* data, unsigned int blocks);
+int sd_write_start(unsigned int lba, const void* data, unsigned int blocks);
+int sd_write_poll(void);
+int sd_write(unsigned int lba, const void* data, unsigned int blocks);
+
+#endif /* SDCARD_H */
@@ -0,0 +1,290 @@
+/**********************************************************************/
+//	sdlog.c   October 17, 2026
+/***********************************************************************
+	SD card session log, see sdlog.h. Everything here runs in the
+	foreground. Mounting and formatting block on the card, so they run
+	before the timers start or with logging stopped. A session only
+	ever goes through sdlog_append() and sdlog_service(), and neither
+	waits for the card.
+
+	head and tail count staged blocks, free running and masked on use.
+	stage[tail] goes to partition block next, so the block being filled
+	lands on next + head - tail.
+***********************************************************************/
+#include "sdlog.h"
+#include "sdcard.h"
+#include "telemetry.h"
+#include "library.h"
+#include "uart.h"
+#include "peripheral.h"
+#include "hal.h"
+
+#define STAGE_MASK		(SDLOG_STAGE_BLOCKS - 1)
+
+typedef char block_is_one_sd_block[sizeof(SdLogBlock) == SD_BLOCK ? 1 : -1];
+
+static SdLogBlock	stage[SDLOG_STAGE_BLOCKS];
+static SdLogBlock	scratch;			// mount and format
+
+static struct {
+	SdLogState state;
+	unsigned int first_lba;		// of the partition
+	unsigned int blocks;		// in the partition
+	unsigned int epoch;
+	unsigned int next;			// partition block stage[tail] goes to
+	unsigned short session;
+	unsigned int head, tail;
+	unsigned int fill;			// records in stage[head]
+	unsigned int lost;			// ticks dropped since stage[head] was opened
+	unsigned int in_flight;		// blocks in the running transfer
+	unsigned int started;		// CLO the transfer started
+} sdl;
+
+SdLogStats sdlog_stats;
+
+//----------------------------------------------------------------------
+//	block checks
+//----------------------------------------------------------------------
+int sdlog_valid(const SdLogBlock* b) {
+	const unsigned char* bytes = (const unsigned char*)b;
+	return (b->header.magic == SDLOG_DATA || b->header.magic == SDLOG_SUPER)
+		&& b->header.crc == crc16_ccitt(bytes + 2, SD_BLOCK - 2);
+}
+
+void sdlog_seal(SdLogBlock* b) {
+	b->header.crc = crc16_ccitt((const unsigned char*)b + 2, SD_BLOCK - 2);
+}
+
+// whether partition block sequence holds data of the current epoch
+static int read_data(unsigned int sequence) {
+	if(sd_read(sdl.first_lba + sequence, &scratch, 1)) return 0;
+	return sdlog_valid(&scratch) && scratch.header.magic == SDLOG_DATA
+		&& scratch.header.epoch == sdl.epoch && scratch.header.sequence == sequence;
+}
+
+static unsigned int le32(const unsigned char* p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+//----------------------------------------------------------------------
+//	mount, format
+//----------------------------------------------------------------------
+// finds the partition, the epoch and the end of the log, 0 or -1
+int sdlog_mount(void) {
+	const unsigned char* mbr = (const unsigned char*)&scratch;
+
+	sdl.state = SDLOG_NONE;
+	sdl.blocks = 0;
+	if(sd_init() || sd_read(0, &scratch, 1)) return -1;
+	if(mbr[510] != 0x55 || mbr[511] != 0xAA) return -1;
+
+	for(int ix = 0; ix < 4; ++ix) {
+		const unsigned char* entry = mbr + 446 + 16 * ix;
+		if(entry[4] != SDLOG_PARTITION) continue;
+		sdl.first_lba = le32(entry + 8);
+		sdl.blocks = le32(entry + 12);
+		break;
+	}
+	if(sdl.blocks < 2) return -1;
+
+	if(sd_read(sdl.first_lba, &scratch, 1)) return -1;
+	if(!sdlog_valid(&scratch) || scratch.header.magic != SDLOG_SUPER) {
+		// a new log or a lost superblock. Every epoch that logged
+		// anything started at block 1, so going one past its epoch
+		// never lets older blocks pass for the new epoch's. With no
+		// data block to go by, the clock makes a repeat unlikely.
+		if(!sd_read(sdl.first_lba + 1, &scratch, 1) && sdlog_valid(&scratch)
+				&& scratch.header.magic == SDLOG_DATA)
+			sdl.epoch = scratch.header.epoch;
+		else sdl.epoch = GET32(CLO);
+		return sdlog_format();
+	}
+	sdl.epoch = scratch.header.epoch;
+
+	unsigned int lo = 1, hi = sdl.blocks;		//first block not written
+	while(lo < hi) {
+		unsigned int mid = lo + ((hi - lo) >> 1);
+		if(read_data(mid)) lo = mid + 1;
+		else hi = mid;
+	}
+	sdl.next = lo;
+	sdl.session = lo > 1 && read_data(lo - 1) ? scratch.header.session : 0;
+	sdl.state = sdl.next < sdl.blocks ? SDLOG_READY : SDLOG_FULL;
+	return 0;
+}
+
+// starts a new epoch, every block logged so far is dropped
+int sdlog_format(void) {
+	if(sdl.blocks < 2) return -1;			//not mounted
+	if(sdl.state == SDLOG_RUNNING || sdl.state == SDLOG_STOPPING) return -1;
+
+	memset(&scratch, 0, sizeof(scratch));
+	scratch.header.magic = SDLOG_SUPER;
+	scratch.header.epoch = ++sdl.epoch;
+	sdlog_seal(&scratch);
+	if(sd_write(sdl.first_lba, &scratch, 1)) {
+		sdl.state = SDLOG_FAILED;
+		return -1;
+	}
+	sdl.next = 1;
+	sdl.session = 0;
+	sdl.state = SDLOG_READY;
+	return 0;
+}
+
+//----------------------------------------------------------------------
+//	sessions
+//----------------------------------------------------------------------
+int sdlog_start(void) {
+	if(sdl.state != SDLOG_READY) return -1;
+	sdl.session++;
+	sdl.head = sdl.tail = 0;
+	sdl.fill = 0;
+	sdl.lost = 0;
+	sdl.in_flight = 0;
+	memset(&sdlog_stats, 0, sizeof(sdlog_stats));
+	sdlog_stats.start_us = GET32(CLO);
+	sdl.state = SDLOG_RUNNING;
+	return 0;
+}
+
+static void close_block(void) {
+	SdLogBlock* b = &stage[sdl.head & STAGE_MASK];
+	b->header.count = sdl.fill;
+	for(unsigned int ix = sdl.fill; ix < SDLOG_RECORDS; ++ix)
+		memset(&b->record[ix], 0, sizeof(SdLogRecord));
+	sdlog_seal(b);
+	sdl.head++;
+	sdl.fill = 0;
+}
+
+void sdlog_stop(void) {
+	if(sdl.state != SDLOG_RUNNING) return;
+	if(sdl.fill) close_block();
+	sdl.state = SDLOG_STOPPING;
+}
+
+void sdlog_append(const TelemetrySample* s) {
+	if(sdl.state != SDLOG_RUNNING) return;
+
+	if(sdl.fill == 0) {						//open the next block
+		unsigned int sequence = sdl.next + sdl.head - sdl.tail;
+		if(sequence >= sdl.blocks) {		//the partition is full
+			sdl.state = SDLOG_STOPPING;
+			sdlog_stats.lost++;
+			return;
+		}
+		if(sdl.head - sdl.tail == SDLOG_STAGE_BLOCKS) {
+			sdl.lost++;
+			sdlog_stats.lost++;
+			return;
+		}
+		SdLogHeader* h = &stage[sdl.head & STAGE_MASK].header;
+		h->session = sdl.session;
+		h->magic = SDLOG_DATA;
+		h->epoch = sdl.epoch;
+		h->sequence = sequence;
+		h->time_us = s->time_us;
+		h->lost = sdl.lost > 0xFFFF ? 0xFFFF : sdl.lost;
+		sdl.lost = 0;
+	}
+
+	SdLogRecord* r = &stage[sdl.head & STAGE_MASK].record[sdl.fill];
+	r->mic_one = s->mic_one;
+	r->mic_two = s->mic_two;
+	r->cuff = s->cuff;
+	r->signal = s->signal;
+	r->reserved = 0;
+	sdlog_stats.records++;
+	if(++sdl.fill == SDLOG_RECORDS) close_block();
+}
+
+//----------------------------------------------------------------------
+//	moves the staged blocks to the card, a step at a time
+//----------------------------------------------------------------------
+void sdlog_service(void) {
+	if(sdl.in_flight) {
+		int status = sd_write_poll();
+		if(status == SD_BUSY) return;
+
+		unsigned int latency = GET32(CLO) - sdl.started;
+		if(status == SD_ERROR) {
+			sdlog_stats.errors++;
+			sdl.in_flight = 0;
+			sdl.state = SDLOG_FAILED;
+			return;
+		}
+		sdlog_stats.transfers++;
+		sdlog_stats.blocks += sdl.in_flight;
+		sdlog_stats.busy_total_us += latency;
+		if(latency > sdlog_stats.latency_max_us) sdlog_stats.latency_max_us = latency;
+		sdl.tail += sdl.in_flight;
+		sdl.next += sdl.in_flight;
+		sdl.in_flight = 0;
+	}
+
+	unsigned int ready = sdl.head - sdl.tail;
+	if(ready) {
+		unsigned int run = SDLOG_STAGE_BLOCKS - (sdl.tail & STAGE_MASK);
+		if(ready > run) ready = run;				//up to the end of the ring
+		if(ready > SDLOG_BURST) ready = SDLOG_BURST;
+		unsigned int started = GET32(CLO);
+		int status = sd_write_start(sdl.first_lba + sdl.next,
+			&stage[sdl.tail & STAGE_MASK], ready);
+		if(status == SD_OK) {
+			sdl.in_flight = ready;
+			sdl.started = started;
+		} else if(status == SD_ERROR) {
+			sdlog_stats.errors++;
+			sdl.state = SDLOG_FAILED;
+		}
+		return;
+	}
+	if(sdl.state == SDLOG_STOPPING)
+		sdl.state = sdl.next < sdl.blocks ? SDLOG_READY : SDLOG_FULL;
+}
+
+// whether sdlog_service() still has work
+int sdlog_active(void) {
+	return sdl.state == SDLOG_RUNNING || sdl.state == SDLOG_STOPPING;
+}
+
+SdLogState sdlog_state(void) {
+	return sdl.state;
+}
+
+unsigned int sdlog_session(void) {
+	return sdl.session;
+}
+
+//----------------------------------------------------------------------
+//	"log ready session 3 blocks 120 lost 0 errors 0 write avg 900 max
+//	31000 us 540 KB/s" over the UART
+//----------------------------------------------------------------------
+void sdlog_report(void) {
+	static const char* const states[] = {
+		"none", "ready", "running", "stopping", "full", "failed"
+	};
+	const SdLogStats* s = &sdlog_stats;
+	char line[128];
+
+	char* p = put_str(line, "log ");
+	p = put_str(p, states[sdl.state]);
+	p = put_str(p, " session ");
+	p = put_uint(p, sdl.session);
+	p = put_str(p, " blocks ");
+	p = put_uint(p, s->blocks);
+	p = put_str(p, " lost ");
+	p = put_uint(p, s->lost);
+	p = put_str(p, " errors ");
+	p = put_uint(p, s->errors);
+	p = put_str(p, " write avg ");
+	p = put_uint(p, s->transfers ? (unsigned int)(s->busy_total_us / s->transfers) : 0);
+	p = put_str(p, " max ");
+	p = put_uint(p, s->latency_max_us);
+	p = put_str(p, " us ");
+	p = put_uint(p, s->busy_total_us ?
+		(unsigned int)((unsigned long long)s->blocks * SD_BLOCK * 1000 / s->busy_total_us) : 0);
+	p = put_str(p, " KB/s\r\n");
+	uart_put_line(line, p);
+}
@@ -0,0 +1,97 @@
+/**********************************************************************/
+//	sdlog.h   October 17, 2026
+/***********************************************************************
+	Append-only session log of the raw samples on the SD card.
+
+	The log lives in its own MBR partition of type SDLOG_PARTITION,
+	made once when the card is prepared, so it is preallocated and never
+	touches the boot partition. Block 0 of the partition is the
+	superblock, and the data blocks follow it in order from block 1.
+	Each block holds SDLOG_RECORDS ticks and a header carrying the
+	log's epoch, its own block number and a CRC-16 over bytes 2-511. A
+	block is valid only if all three check out, so the blocks written
+	since the last format form a prefix of the partition, and mounting
+	finds its end by binary search. Formatting just moves to a new
+	epoch, which leaves every older block invalid. The log never wraps.
+	Once the partition is full it stops.
+
+	sdlog_append() takes each tick in the foreground and copies it into
+	a ring of SDLOG_STAGE_BLOCKS staged blocks. sdlog_service() writes
+	the full blocks out in multi-block transfers of up to SDLOG_BURST
+	through the non-blocking side of sdcard.c. A tick that finds the
+	ring full is dropped, and the count goes in the next block's lost
+	field.
+***********************************************************************/
+#ifndef SDLOG_H
+#define SDLOG_H
+
+#include "telemetry.h"
+
+#define SDLOG_PARTITION		0xDA		// MBR type, non-filesystem data
+#define SDLOG_SUPER			0x53535042	// "BPSS"
+#define SDLOG_DATA			0x4C535042	// "BPSL"
+#define SDLOG_RECORDS		61
+#define SDLOG_STAGE_BLOCKS	32			// power of two, 2.4 s of ticks
+#define SDLOG_BURST			8
+
+typedef struct {
+	short mic_one;
+	short mic_two;
+	unsigned short cuff;
+	signed char signal;
+	unsigned char reserved;
+} SdLogRecord;
+
+typedef struct {
+	unsigned short crc;			// CRC-16/CCITT-FALSE of bytes 2-511
+	unsigned short session;		// counts from 1 within the epoch
+	unsigned int magic;			// SDLOG_SUPER or SDLOG_DATA
+	unsigned int epoch;
+	unsigned int sequence;		// block number in the partition
+	unsigned int time_us;		// CLO of the first record
+	unsigned short count;		// records used
+	unsigned short lost;		// ticks dropped just before the first
+} SdLogHeader;
+
+typedef struct {
+	SdLogHeader header;
+	SdLogRecord record[SDLOG_RECORDS];
+} SdLogBlock;					// exactly one 512 byte SD block
+
+typedef enum {
+	SDLOG_NONE,				// no card, or no log partition on it
+	SDLOG_READY,
+	SDLOG_RUNNING,
+	SDLOG_STOPPING,			// flushing the staged blocks
+	SDLOG_FULL,
+	SDLOG_FAILED			// write error, the session is over
+} SdLogState;
+
+typedef struct {
+	unsigned int records;
+	unsigned int lost;
+	unsigned int blocks;
+	unsigned int transfers;
+	unsigned int errors;
+	unsigned int latency_max_us;	// transfer start to the card done
+	unsigned long long busy_total_us;
+	unsigned int start_us;			// CLO when the session started
+} SdLogStats;
+
+extern SdLogStats sdlog_stats;
+
+int  sdlog_mount(void);
+int  sdlog_format(void);
+int  sdlog_start(void);
+void sdlog_stop(void);
+void sdlog_append(const TelemetrySample* s);
+void sdlog_service(void);
+int  sdlog_active(void);
+SdLogState sdlog_state(void);
+unsigned int sdlog_session(void);
+void sdlog_report(void);
+
+int  sdlog_valid(const SdLogBlock* b);
+void sdlog_seal(SdLogBlock* b);
+
+#endif /* SDLOG_H */
@@ -20,7 +20,7 @@ prefetch_handler:   .word hang
 data_handler:       .word hang
 unused_handler:     .word hang
 irq_handler:        .word irq
-fiq_handler:        .word hang
+fiq_handler:        .word fiq
 
 reset:
     mov r0,#0x8000
@@ -57,6 +57,13 @@ reset:
     mov r0,#0x40000000
     fmxr fpexc,r0
 
+    ;@ start the cycle counter, PMNC E and C bits
+    mov r0,#0x5
+    mcr p15, 0, r0, c15, c12, 0
+
+    ;@ page tables, caches and branch prediction, mmu.c
+    bl mmu_init
+
     bl _main_
     
 hang: b hang
@@ -105,6 +112,11 @@ GETCPSR:
 BRANCHTO:
     bx r0
 
+.globl hal_cycles
+hal_cycles:
+    mrc p15, 0, r0, c15, c12, 1
+    bx lr
+
 .globl dummy
 dummy:
     bx lr
@@ -112,7 +124,7 @@ dummy:
 .globl enable_irq
 enable_irq:
     mrs r0,cpsr
-    bic r0,r0,#0x80
+    bic r0,r0,#0xC0
     msr cpsr_c,r0
     bx lr
 
@@ -123,11 +135,33 @@ disable_irq:
     msr cpsr_c,r0
     bx lr
   
+;@ the foreground signal path runs on the VFP and gcc may use it in
+;@ the handlers too, so both stubs save the registers a C call may
+;@ clobber, d0-d7 and FPSCR. d8-d15 are callee saved. r4 keeps FPSCR
+;@ across the call.
 irq:
     stmfd sp!, {r0-r12,lr}
+    fmrx r4,fpscr
+    vpush {d0-d7}
     bl irq_service_routine
+    vpop {d0-d7}
+    fmxr fpscr,r4
     ldmfd sp!, {r0-r12,lr}
     subs pc,lr,#4
 
+;@ the sample tick, see kernel.c. r8-r12 are banked in FIQ mode and
+;@ the C handler saves r4-r7 itself, so only r0-r3 and lr need
+;@ stacking, r12 keeps the stack 8 byte aligned. The VFP state is
+;@ saved as in irq, in the banked r8.
+fiq:
+    sub lr,lr,#4
+    stmfd sp!, {r0-r3,r12,lr}
+    fmrx r8,fpscr
+    vpush {d0-d7}
+    bl fiq_service_routine
+    vpop {d0-d7}
+    fmxr fpscr,r8
+    ldmfd sp!, {r0-r3,r12,pc}^
+
 ;@----------------------------------------------------------------------
 ;@----------------------------------------------------------------------
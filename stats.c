@@ -0,0 +1,209 @@
+/**********************************************************************/
+//	stats.c   October 17, 2026
+/***********************************************************************
+	Window sum and sum of squares kernels, see stats.h. Each vector
+	kernel runs its main loop on whole vectors and leaves the tail, and
+	on ARM an unaligned leading sample, to the scalar loop.
+
+	The ARMv6 kernel gets the sum from SMLAD against 0x00010001, which
+	adds both halfwords of a word to the accumulator in one go, and the
+	squares from SMLALD of a word with itself into a 64 bit accumulator.
+	SADD16 would need the sum split across 16 bit lanes that overflow
+	within a few samples, and USAD8 works on unsigned bytes, so neither
+	suits int16 samples.
+
+	The x86 kernels multiply-add pairs with pmaddwd. A pair of squares
+	is at most 2^31, which fits a 32 bit lane taken as unsigned, and is
+	widened into 64 bit lanes every step. Pair sums stay in 32 bit
+	lanes, which is exact for any window up to STATS_MAX_WINDOW.
+***********************************************************************/
+#if !defined(__ARM_FEATURE_SIMD32) && defined(__AVX2__)
+#include <immintrin.h>
+#elif !defined(__ARM_FEATURE_SIMD32) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "stats.h"
+#include "math.h"
+
+//----------------------------------------------------------------------
+void stats_s16_scalar(const int16_t* x, int n, WindowStats* out) {
+	int64_t sum = 0;
+	uint64_t squares = 0;
+
+	for(int ix = 0; ix < n; ++ix) {
+		sum += x[ix];
+		squares += (uint32_t)((int32_t)x[ix] * x[ix]);
+	}
+	out->sum = sum;
+	out->squares = squares;
+	out->count = n;
+}
+
+//----------------------------------------------------------------------
+#if defined(__ARM_FEATURE_SIMD32)
+
+static inline int32_t smlad(uint32_t a, uint32_t b, int32_t acc) {
+	int32_t result;
+	__asm__("smlad %0, %1, %2, %3" : "=r"(result) : "r"(a), "r"(b), "r"(acc));
+	return result;
+}
+
+static inline int64_t smlald(uint32_t a, uint32_t b, int64_t acc) {
+	uint32_t lo = (uint32_t)acc, hi = (uint32_t)((uint64_t)acc >> 32);
+	__asm__("smlald %0, %1, %2, %3" : "+r"(lo), "+r"(hi) : "r"(a), "r"(b));
+	return (int64_t)(((uint64_t)hi << 32) | lo);
+}
+
+void stats_s16(const int16_t* x, int n, WindowStats* out) {
+	int32_t sum = 0;
+	int64_t squares = 0;
+	int ix = 0;
+
+	if(((unsigned int)x & 2) && n > 0) {		//word align the loads
+		sum = x[0];
+		squares = (int32_t)x[0] * x[0];
+		ix = 1;
+	}
+	const uint32_t* words = (const uint32_t*)(x + ix);
+	int pairs = (n - ix) / 2;
+	for(int jx = 0; jx + 1 < pairs; jx += 2) {
+		uint32_t a = words[jx], b = words[jx + 1];
+		sum = smlad(a, 0x00010001, sum);
+		sum = smlad(b, 0x00010001, sum);
+		squares = smlald(a, a, squares);
+		squares = smlald(b, b, squares);
+	}
+	if(pairs & 1) {
+		uint32_t a = words[pairs - 1];
+		sum = smlad(a, 0x00010001, sum);
+		squares = smlald(a, a, squares);
+	}
+	for(ix += pairs * 2; ix < n; ++ix) {
+		sum += x[ix];
+		squares += (int32_t)x[ix] * x[ix];
+	}
+	out->sum = sum;
+	out->squares = (uint64_t)squares;
+	out->count = n;
+}
+
+const char* stats_kernel(void) {
+	return "ARMv6 SIMD";
+}
+
+//----------------------------------------------------------------------
+#elif defined(__AVX2__)
+
+void stats_s16(const int16_t* x, int n, WindowStats* out) {
+	const __m256i ones = _mm256_set1_epi16(1);
+	__m256i sum = _mm256_setzero_si256();
+	__m256i squares = _mm256_setzero_si256();
+	int ix = 0;
+
+	for(; ix + 16 <= n; ix += 16) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)(x + ix));
+		__m256i sq = _mm256_madd_epi16(v, v);		//pairs, unsigned
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, ones));
+		squares = _mm256_add_epi64(squares,
+			_mm256_cvtepu32_epi64(_mm256_castsi256_si128(sq)));
+		squares = _mm256_add_epi64(squares,
+			_mm256_cvtepu32_epi64(_mm256_extracti128_si256(sq, 1)));
+	}
+
+	int32_t sum_lanes[8];
+	uint64_t square_lanes[4];
+	_mm256_storeu_si256((__m256i*)sum_lanes, sum);
+	_mm256_storeu_si256((__m256i*)square_lanes, squares);
+
+	WindowStats tail;
+	stats_s16_scalar(x + ix, n - ix, &tail);
+	out->sum = tail.sum;
+	out->squares = tail.squares;
+	for(int jx = 0; jx < 8; ++jx) out->sum += sum_lanes[jx];
+	for(int jx = 0; jx < 4; ++jx) out->squares += square_lanes[jx];
+	out->count = n;
+}
+
+const char* stats_kernel(void) {
+	return "AVX2";
+}
+
+//----------------------------------------------------------------------
+#elif defined(__SSE2__)
+
+void stats_s16(const int16_t* x, int n, WindowStats* out) {
+	const __m128i ones = _mm_set1_epi16(1);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i sum = _mm_setzero_si128();
+	__m128i squares = _mm_setzero_si128();
+	int ix = 0;
+
+	for(; ix + 8 <= n; ix += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(x + ix));
+		__m128i sq = _mm_madd_epi16(v, v);			//pairs, unsigned
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(v, ones));
+		squares = _mm_add_epi64(squares, _mm_unpacklo_epi32(sq, zero));
+		squares = _mm_add_epi64(squares, _mm_unpackhi_epi32(sq, zero));
+	}
+
+	int32_t sum_lanes[4];
+	uint64_t square_lanes[2];
+	_mm_storeu_si128((__m128i*)sum_lanes, sum);
+	_mm_storeu_si128((__m128i*)square_lanes, squares);
+
+	WindowStats tail;
+	stats_s16_scalar(x + ix, n - ix, &tail);
+	out->sum = tail.sum + sum_lanes[0] + sum_lanes[1] + sum_lanes[2] + sum_lanes[3];
+	out->squares = tail.squares + square_lanes[0] + square_lanes[1];
+	out->count = n;
+}
+
+const char* stats_kernel(void) {
+	return "SSE2";
+}
+
+//----------------------------------------------------------------------
+#else
+
+void stats_s16(const int16_t* x, int n, WindowStats* out) {
+	stats_s16_scalar(x, n, out);
+}
+
+const char* stats_kernel(void) {
+	return "portable";
+}
+#endif
+
+//----------------------------------------------------------------------
+//	the last n samples of a ring, the kernel once per span
+//----------------------------------------------------------------------
+void stats_ring_s16(const Ring* r, int n, WindowStats* out) {
+	RingSpan span[2];
+	WindowStats part;
+	int spans = ring_window(r, n, span);
+
+	out->sum = 0;
+	out->squares = 0;
+	out->count = 0;
+	for(int ix = 0; ix < spans; ++ix) {
+		stats_s16(span[ix].data, span[ix].count, &part);
+		out->sum += part.sum;
+		out->squares += part.squares;
+		out->count += part.count;
+	}
+}
+
+//----------------------------------------------------------------------
+//	mean and sample deviation, as meani/stddevi compute them
+//----------------------------------------------------------------------
+float stats_mean(const WindowStats* s) {
+	return s->count ? (float)((double)s->sum / s->count) : 0;
+}
+
+float stats_deviation(const WindowStats* s) {
+	if(s->count < 2) return 0;
+	double sum = (double)s->sum;
+	double dev_sqr_sum = (double)s->squares - sum * sum / s->count;
+	if(dev_sqr_sum <= 0) return 0;
+	return (float)sqrt(dev_sqr_sum / (s->count - 1));
+}
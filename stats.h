@@ -0,0 +1,39 @@
+/**********************************************************************/
+//	stats.h   October 17, 2026
+/***********************************************************************
+	Single pass sum and sum of squares over a window of int16 samples,
+	from which the mean and sample deviation follow without a second
+	pass. stats_s16() picks the widest kernel the build allows:
+
+	  ARMv6 SIMD	SMLAD and SMLALD, two samples per instruction
+	  AVX2			_mm256_madd_epi16, sixteen samples per step
+	  SSE2			_mm_madd_epi16, eight samples per step
+	  portable		stats_s16_scalar()
+
+	All of them produce the exact integer sums for any window shorter
+	than STATS_MAX_WINDOW samples. stats_ring_s16() runs the kernel over
+	the last n samples of an int16 Ring, a span at a time.
+***********************************************************************/
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include "ring.h"
+
+#define STATS_MAX_WINDOW	65536
+
+typedef struct {
+	int64_t sum;
+	uint64_t squares;
+	int count;
+} WindowStats;
+
+void stats_s16(const int16_t* x, int n, WindowStats* out);
+void stats_s16_scalar(const int16_t* x, int n, WindowStats* out);
+void stats_ring_s16(const Ring* r, int n, WindowStats* out);
+const char* stats_kernel(void);
+
+float stats_mean(const WindowStats* s);
+float stats_deviation(const WindowStats* s);
+
+#endif /* STATS_H */
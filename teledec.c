@@ -0,0 +1,76 @@
+/**********************************************************************/
+//	teledec.c   October 17, 2026
+/***********************************************************************
+	Host decoder for the binary telemetry stream. Reads a capture of
+	the UART output, from a file or stdin, splits it on 0x00, decodes
+	each frame and reports frame loss from the sequence numbers and
+	the achieved throughput from the board's own timestamps.
+
+	usage: bpsure_teledec [capture.bin] [-v]
+	       -v prints one line per frame
+***********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "telemetry.h"
+
+int main(int argc, char** argv) {
+	FILE* in = stdin;
+	int verbose = 0;
+	unsigned char frame[256];
+	int len = 0, c;
+	unsigned long long bytes = 0, elapsed_us = 0;
+	unsigned int frames = 0, lost = 0, crc_errors = 0, bad_frames = 0;
+	unsigned int first_bytes = 0;
+	unsigned short seq, last_seq = 0;
+	unsigned int last_time = 0;
+	TelemetrySample s;
+
+	for(int ix = 1; ix < argc; ++ix) {
+		if(argv[ix][0] == '-' && argv[ix][1] == 'v') verbose = 1;
+		else if(!(in = fopen(argv[ix], "rb"))) {
+			perror(argv[ix]);
+			return 1;
+		}
+	}
+
+	while((c = fgetc(in)) != EOF) {
+		bytes++;
+		if(c != 0) {
+			if(len < (int)sizeof(frame)) frame[len] = c;
+			len++;
+			continue;
+		}
+		if(len == 0) continue;
+
+		int result = len > (int)sizeof(frame) ? -1 :
+			telemetry_decode(frame, len, &s, &seq);
+		len = 0;
+		if(result == -2) { crc_errors++; continue; }
+		if(result < 0) { bad_frames++; continue; }
+
+		if(frames == 0) first_bytes = bytes;
+		else {
+			lost += (unsigned short)(seq - last_seq - 1);
+			elapsed_us += s.time_us - last_time;
+		}
+		last_seq = seq;
+		last_time = s.time_us;
+		frames++;
+
+		if(verbose)
+			printf("%5u %10u %6d %6d %4u %11d %5u %2d\n", seq, s.time_us,
+				s.mic_one, s.mic_two, s.cuff, s.product, s.deviation, s.signal);
+	}
+
+	printf("telemetry decode\n");
+	printf("  %u frames  %u lost  %u CRC errors  %u bad frames\n",
+		frames, lost, crc_errors, bad_frames);
+	if(frames + lost)
+		printf("  frame loss %.3f%%\n", 100.0 * lost / (frames + lost));
+	if(elapsed_us) {
+		double seconds = elapsed_us / 1e6;
+		printf("  %.3f s of board time  %.1f frames/s  %.0f bytes/s\n",
+			seconds, (frames - 1) / seconds, (bytes - first_bytes) / seconds);
+	}
+	return 0;
+}
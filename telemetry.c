@@ -0,0 +1,160 @@
+/**********************************************************************/
+//	telemetry.c   October 17, 2026
+/***********************************************************************
+	Framed binary telemetry, see telemetry.h for the layout. Frames are
+	built by the telemetry task in the foreground and handed to the
+	UART TX ring whole, or not at all. A frame that does not fit is
+	counted as dropped and its sequence number is skipped so the
+	decoder sees the gap.
+***********************************************************************/
+#include "telemetry.h"
+#include "uart.h"
+
+volatile TelemetryStats telemetry_stats;
+
+static volatile int enabled = 0;
+static unsigned short sequence = 0;
+
+//----------------------------------------------------------------------
+void telemetry_enable(int on) {
+	enabled = on;
+}
+
+int telemetry_enabled(void) {
+	return enabled;
+}
+
+//----------------------------------------------------------------------
+void telemetry_sample(const TelemetrySample *s) {
+	unsigned char frame[TELEMETRY_FRAME_MAX];
+
+	if(!enabled) return;
+	int len = telemetry_encode(s, sequence++, frame);
+	if(uart_tx_room() < len) {
+		telemetry_stats.dropped++;
+		return;
+	}
+	uart_write(frame, len);
+	telemetry_stats.sent++;
+}
+
+//----------------------------------------------------------------------
+// CRC-16/CCITT-FALSE, polynomial 0x1021, initial value 0xFFFF, a
+// nibble at a time from a 16 entry table
+//----------------------------------------------------------------------
+unsigned short crc16_ccitt(const unsigned char *data, int len) {
+	static const unsigned short table[16] = {
+		0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+		0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+	};
+	unsigned short crc = 0xFFFF;
+
+	while(len--) {
+		unsigned char b = *data++;
+		crc = (crc << 4) ^ table[(crc >> 12) ^ (b >> 4)];
+		crc = (crc << 4) ^ table[(crc >> 12) ^ (b & 0x0F)];
+	}
+	return crc;
+}
+
+//----------------------------------------------------------------------
+// Consistent Overhead Byte Stuffing. dst needs len + len/254 + 1 bytes.
+// Returns the encoded length, which never contains a zero.
+//----------------------------------------------------------------------
+int cobs_encode(const unsigned char *src, int len, unsigned char *dst) {
+	int code_at = 0, out = 1;
+	unsigned char code = 1;
+
+	for(int ix = 0; ix < len; ++ix) {
+		if(src[ix]) {
+			dst[out++] = src[ix];
+			code++;
+		}
+		if(!src[ix] || code == 0xFF) {
+			dst[code_at] = code;
+			code = 1;
+			code_at = out++;
+		}
+	}
+	dst[code_at] = code;
+	return out;
+}
+
+// Returns the decoded length, or -1 for a malformed block or one that
+// would not fit in size bytes
+int cobs_decode(const unsigned char *src, int len, unsigned char *dst, int size) {
+	int in = 0, out = 0;
+
+	while(in < len) {
+		unsigned char code = src[in++];
+		if(code == 0 || in + code - 1 > len || out + code > size) return -1;
+		for(int ix = 1; ix < code; ++ix)
+			dst[out + ix - 1] = src[in + ix - 1];
+		in += code - 1;
+		out += code - 1;
+		if(code != 0xFF && in < len)
+			dst[out++] = 0;
+	}
+	return out;
+}
+
+//----------------------------------------------------------------------
+static void put16(unsigned char *p, unsigned int v) {
+	p[0] = v;
+	p[1] = v >> 8;
+}
+
+static void put32(unsigned char *p, unsigned int v) {
+	put16(p, v);
+	put16(p + 2, v >> 16);
+}
+
+static unsigned int get16(const unsigned char *p) {
+	return p[0] | (p[1] << 8);
+}
+
+static unsigned int get32(const unsigned char *p) {
+	return get16(p) | (get16(p + 2) << 16);
+}
+
+// builds a complete frame, COBS and delimiter included, returns its length
+int telemetry_encode(const TelemetrySample *s, unsigned short seq, unsigned char *frame) {
+	unsigned char raw[TELEMETRY_RAW];
+
+	raw[0] = TELEMETRY_SAMPLE;
+	put16(raw + 1, seq);
+	put32(raw + 3, s->time_us);
+	put16(raw + 7, s->mic_one);
+	put16(raw + 9, s->mic_two);
+	put16(raw + 11, s->cuff);
+	put32(raw + 13, s->product);
+	put16(raw + 17, s->deviation);
+	raw[19] = s->signal;
+	put16(raw + 20, crc16_ccitt(raw, TELEMETRY_PAYLOAD));
+
+	int len = cobs_encode(raw, TELEMETRY_RAW, frame);
+	frame[len++] = 0;
+	return len;
+}
+
+// decodes one frame without its 0x00 delimiter. Returns 0 on success,
+// -1 for bad framing or length and -2 for a CRC mismatch
+int telemetry_decode(const unsigned char *frame, int len, TelemetrySample *s,
+	unsigned short *seq) {
+	unsigned char raw[TELEMETRY_FRAME_MAX];
+
+	if(len > TELEMETRY_FRAME_MAX) return -1;
+	if(cobs_decode(frame, len, raw, sizeof(raw)) != TELEMETRY_RAW) return -1;
+	if(raw[0] != TELEMETRY_SAMPLE) return -1;
+	if(get16(raw + 20) != crc16_ccitt(raw, TELEMETRY_PAYLOAD)) return -2;
+
+	*seq = get16(raw + 1);
+	s->time_us = get32(raw + 3);
+	s->mic_one = get16(raw + 7);
+	s->mic_two = get16(raw + 9);
+	s->cuff = get16(raw + 11);
+	s->product = get32(raw + 13);
+	s->deviation = get16(raw + 17);
+	s->signal = raw[19];
+	return 0;
+}
@@ -0,0 +1,56 @@
+/**********************************************************************/
+//	telemetry.h   October 17, 2026
+/***********************************************************************
+	Binary telemetry frames over the mini UART.
+
+	payload, little endian:
+	  0  u8   type (TELEMETRY_SAMPLE)
+	  1  u16  sequence, counts every frame including dropped ones
+	  3  u32  system timer, us
+	  7  i16  mic one raw
+	  9  i16  mic two raw
+	 11  u16  cuff pressure, processed
+	 13  i32  process_microphones() product
+	 17  u16  deviation of the ring buffer window, saturated
+	 19  i8   z-score signal
+	 20  u16  CRC-16/CCITT-FALSE over bytes 0..19
+
+	The payload and CRC are COBS encoded and ended by a 0x00, so a
+	receiver can resynchronise on any zero byte.
+***********************************************************************/
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#define TELEMETRY_SAMPLE	0x01
+#define TELEMETRY_PAYLOAD	20
+#define TELEMETRY_RAW		(TELEMETRY_PAYLOAD + 2)		// with CRC
+#define TELEMETRY_FRAME_MAX	(TELEMETRY_RAW + 2)			// COBS code, 0x00
+
+typedef struct {
+	unsigned int time_us;
+	short mic_one;
+	short mic_two;
+	unsigned short cuff;
+	int product;
+	unsigned short deviation;
+	signed char signal;
+} TelemetrySample;
+
+typedef struct {
+	unsigned int sent;
+	unsigned int dropped;		// no room in the UART TX ring
+} TelemetryStats;
+
+extern volatile TelemetryStats telemetry_stats;
+
+void telemetry_enable(int);
+int  telemetry_enabled(void);
+void telemetry_sample(const TelemetrySample *);
+
+int telemetry_encode(const TelemetrySample *, unsigned short, unsigned char *);
+int telemetry_decode(const unsigned char *, int, TelemetrySample *, unsigned short *);
+unsigned short crc16_ccitt(const unsigned char *, int);
+int cobs_encode(const unsigned char *, int, unsigned char *);
+int cobs_decode(const unsigned char *, int, unsigned char *, int);
+
+#endif /* TELEMETRY_H */
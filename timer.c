@@ -0,0 +1,85 @@
+/**********************************************************************/
+//	timer.c   October 17, 2026
+/***********************************************************************
+	Absolute deadline jobs on the system timer, see timer.h. CLO wraps
+	every 71 minutes, so times are compared as signed differences.
+***********************************************************************/
+#include "timer.h"
+#include "peripheral.h"
+#include "library.h"
+#include "uart.h"
+#include "hal.h"
+
+#define COMPARE(channel)	(C0 + 4 * (channel))
+
+//----------------------------------------------------------------------
+void timer_start(TimerJob* job, unsigned int channel, unsigned int period_us) {
+	job->channel = channel;
+	job->period_us = period_us;
+	memset(&job->stats, 0, sizeof(job->stats));
+	job->deadline = GET32(CLO) + period_us;
+	PUT32(COMPARE(channel), job->deadline);
+	PUT32(CS, TIMER_IRQ(job));
+}
+
+// services the match, returns the deadline it was for
+unsigned int timer_service(TimerJob* job) {
+	unsigned int now = GET32(CLO);
+	unsigned int deadline = job->deadline;
+	TimerStats* s = &job->stats;
+
+	timer_record(s, now - deadline);
+
+	unsigned int next = deadline + job->period_us;
+	while((int)(next - now) < TIMER_MIN_LEAD_US) {
+		next += job->period_us;
+		s->missed++;
+	}
+	job->deadline = next;
+	PUT32(COMPARE(job->channel), next);
+	PUT32(CS, TIMER_IRQ(job));
+	return deadline;
+}
+
+//----------------------------------------------------------------------
+//	statistics, copied and cleared with the IRQ and FIQ masked
+//----------------------------------------------------------------------
+void timer_record(TimerStats* s, unsigned int late) {
+	if(s->count == 0 || late < s->late_min) s->late_min = late;
+	if(late > s->late_max) s->late_max = late;
+	s->late_total += late;
+	s->count++;
+}
+
+void timer_read(const TimerStats* from, TimerStats* stats) {
+	disable_irq();
+	*stats = *from;
+	enable_irq();
+}
+
+void timer_reset(TimerStats* stats) {
+	disable_irq();
+	memset(stats, 0, sizeof(*stats));
+	enable_irq();
+}
+
+// "name n 1234 missed 0 late min 2 avg 3 max 9 us" over the UART
+void timer_report(const char* name, const TimerStats* stats) {
+	char line[96];
+	TimerStats s;
+
+	timer_read(stats, &s);
+	char* p = put_str(line, name);
+	p = put_str(p, " n ");
+	p = put_uint(p, s.count);
+	p = put_str(p, " missed ");
+	p = put_uint(p, s.missed);
+	p = put_str(p, " late min ");
+	p = put_uint(p, s.late_min);
+	p = put_str(p, " avg ");
+	p = put_uint(p, s.count ? (unsigned int)(s.late_total / s.count) : 0);
+	p = put_str(p, " max ");
+	p = put_uint(p, s.late_max);
+	p = put_str(p, " us\r\n");
+	uart_put_line(line, p);
+}
@@ -0,0 +1,49 @@
+/**********************************************************************/
+//	timer.h   October 17, 2026
+/***********************************************************************
+	Periodic jobs on the system timer compare channels the GPU leaves
+	free, C1 and C3. Each job keeps an absolute deadline in CLO time
+	and re-arms its compare at deadline + period. Interrupt latency
+	then shows up as jitter on that one tick, never as drift, and the
+	rate is exactly 1MHz / period_us.
+
+	timer_service() is called from the IRQ handler when the job's match
+	bit is set. It records how late the handler got there, arms the
+	next deadline and clears the match. A deadline that has already
+	passed by the time it would be armed is counted as missed and
+	skipped, since the compare only fires when CLO equals it.
+
+	The statistics can also be kept for any other lateness against a
+	deadline, through timer_record().
+***********************************************************************/
+#ifndef TIMER_H
+#define TIMER_H
+
+#define TIMER_MIN_LEAD_US	4		// closer than this counts as passed
+
+typedef struct {
+	unsigned int count;			// deadlines serviced
+	unsigned int missed;		// deadlines skipped
+	unsigned int late_min;		// handler entry after the deadline, us
+	unsigned int late_max;
+	unsigned long long late_total;
+} TimerStats;
+
+typedef struct {
+	unsigned int channel;		// 1 or 3
+	unsigned int period_us;
+	unsigned int deadline;		// CLO the compare is armed for
+	TimerStats stats;
+} TimerJob;
+
+void timer_start(TimerJob* job, unsigned int channel, unsigned int period_us);
+unsigned int timer_service(TimerJob* job);
+void timer_record(TimerStats* stats, unsigned int late);
+void timer_read(const TimerStats* from, TimerStats* stats);
+void timer_reset(TimerStats* stats);
+void timer_report(const char* name, const TimerStats* stats);
+
+// match bit of a job's channel in IRQ_PEND1 and CS
+#define TIMER_IRQ(job)	(1u << (job)->channel)
+
+#endif /* TIMER_H */
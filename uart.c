@@ -0,0 +1,170 @@
+/**********************************************************************/
+//	uart.c   October 17, 2026
+/***********************************************************************
+	Interrupt driven AUX mini UART on GPIO14/15.
+
+	Both rings are single producer, single consumer. The RX ring is
+	filled by uart_isr() and drained by the foreground, the TX ring the
+	other way round. Head and tail are free running and masked on use,
+	so head - tail is the fill level without any sign fix-ups, and
+	each index is only ever written by its own side.
+
+	The TX writers are for the foreground only. They mask interrupts
+	while they fill the ring and move the head, so a report and a
+	telemetry frame can never interleave or claim the same slots, and
+	the enable at the end must not run inside a handler.
+
+	The TX interrupt is only enabled while the TX ring holds data. The
+	ISR turns it off again once the ring is empty.
+***********************************************************************/
+#include "uart.h"
+#include "library.h"
+#include "peripheral.h"
+#include "hal.h"
+
+#define RX_MASK	(COM_RX_Buffer_Size - 1)
+#define TX_MASK	(COM_TX_Buffer_Size - 1)
+
+// AUX_MU_IER_REG, bit 0 receive and bit 1 transmit. Bits 2 and 3 must
+// also be set for the mini UART interrupt to reach the interrupt
+// controller
+#define IER_RX		0x0D
+#define IER_RX_TX	0x0F
+
+#define LSR_DATA_READY	0x01
+#define LSR_TX_EMPTY	0x20
+
+#define barrier() __asm__ __volatile__("" ::: "memory")
+
+static unsigned char COM_RX_Buffer[COM_RX_Buffer_Size];
+static unsigned char COM_TX_Buffer[COM_TX_Buffer_Size];
+static volatile unsigned int rx_head = 0, rx_tail = 0;
+static volatile unsigned int tx_head = 0, tx_tail = 0;
+
+volatile UartStats uart_stats;
+
+//----------------------------------------------------------------------
+//	UART System Initialization
+//----------------------------------------------------------------------
+void uart_init(void) {
+    unsigned int ra;
+    //alt function 5 for uart1
+	 gpioMODE(14, ALT5); //GPIO14 TXD
+	 gpioMODE(15, ALT5); //GPIO15 RXD
+
+    PUT32(AUX_ENABLES,1);
+    PUT32(AUX_MU_IER_REG,0);
+    PUT32(AUX_MU_CNTL_REG,0);
+    PUT32(AUX_MU_LCR_REG,3);
+    PUT32(AUX_MU_MCR_REG,0);
+	 PUT32(AUX_MU_IER_REG, 0);
+    PUT32(AUX_MU_IIR_REG,0xC6);
+    PUT32(AUX_MU_BAUD_REG,UART_BAUD_REG);
+ 
+    PUT32(GPPUD,0);
+    for(ra=0;ra<150;ra++) dummy(ra);
+    PUT32(GPPUDCLK0,(3<<14));
+    for(ra=0;ra<150;ra++) dummy(ra);
+    PUT32(GPPUDCLK0,0);
+    PUT32(AUX_MU_CNTL_REG,3);
+
+	rx_head = rx_tail = 0;
+	tx_head = tx_tail = 0;
+	uart_stats.rx_overflow = 0;
+	uart_stats.tx_overflow = 0;
+
+	PUT32(AUX_MU_IER_REG, IER_RX);
+	PUT32(IRQ_ENABLE1, UART_IRQ);
+}
+//----------------------------------------------------------------------
+int uart_getc(void) {
+	int char_in;
+	if(rx_tail != rx_head) {
+		char_in = COM_RX_Buffer[rx_tail & RX_MASK];
+		barrier();
+		rx_tail++;
+	}
+	else char_in = COM_RX_BUFFER_EMPTY;
+	return char_in;
+}
+//----------------------------------------------------------------------
+int uart_putc(int char_out) {
+	int status = RETURN_SUCCESS;
+
+	disable_irq();
+	if(tx_head - tx_tail < COM_TX_Buffer_Size) {
+		COM_TX_Buffer[tx_head & TX_MASK] = char_out;
+		barrier();
+		tx_head++;
+		PUT32(AUX_MU_IER_REG, IER_RX_TX);
+	} else {
+		uart_stats.tx_overflow++;
+		status = COM_TX_BUFFER_FULL;
+	}
+	enable_irq();
+	return status;
+}
+//----------------------------------------------------------------------
+void uart_puts(char *s) {
+	while(*s)
+		uart_putc(*s++);
+}
+//----------------------------------------------------------------------
+// queues up to len bytes, returns how many were taken. The rest are
+// counted as TX overflow.
+//----------------------------------------------------------------------
+int uart_write(const void *buf, int len) {
+	const unsigned char *src = buf;
+
+	disable_irq();
+	unsigned int head = tx_head;
+	unsigned int room = COM_TX_Buffer_Size - (head - tx_tail);
+	int count = len < (int)room ? len : (int)room;
+
+	for(int ix = 0; ix < count; ++ix)
+		COM_TX_Buffer[(head + ix) & TX_MASK] = src[ix];
+	barrier();
+	tx_head = head + count;
+
+	if(count < len) uart_stats.tx_overflow += len - count;
+	if(count) PUT32(AUX_MU_IER_REG, IER_RX_TX);
+	enable_irq();
+	return count;
+}
+//----------------------------------------------------------------------
+int uart_tx_room(void) {
+	return COM_TX_Buffer_Size - (tx_head - tx_tail);
+}
+//----------------------------------------------------------------------
+// queues line up to end once the ring has room for all of it, so a
+// console report is never cut short. Needs interrupts on.
+//----------------------------------------------------------------------
+void uart_put_line(const char *line, const char *end) {
+	while(uart_tx_room() < end - line) continue;	//the ISR drains it
+	uart_write(line, end - line);
+}
+//----------------------------------------------------------------------
+// AUX interrupt, drains the receive FIFO and refills the transmit FIFO
+//----------------------------------------------------------------------
+void uart_isr(void) {
+	unsigned int lsr;
+
+	while((lsr = GET32(AUX_MU_LSR_REG)) & LSR_DATA_READY) {
+		unsigned char c = GET8(AUX_MU_IO_REG);
+		if(rx_head - rx_tail < COM_RX_Buffer_Size) {
+			COM_RX_Buffer[rx_head & RX_MASK] = c;
+			barrier();
+			rx_head++;
+		}
+		else uart_stats.rx_overflow++;
+	}
+
+	unsigned int tail = tx_tail;
+	while(tail != tx_head && (GET32(AUX_MU_LSR_REG) & LSR_TX_EMPTY)) {
+		PUT8(AUX_MU_IO_REG, COM_TX_Buffer[tail & TX_MASK]);
+		tail++;
+	}
+	tx_tail = tail;
+
+	if(tail == tx_head) PUT32(AUX_MU_IER_REG, IER_RX);
+}
@@ -0,0 +1,34 @@
+/**********************************************************************/
+//	uart.h   October 17, 2026
+/**********************************************************************/
+#ifndef UART_H
+#define UART_H
+
+#define COM_RX_Buffer_Size    1024		// powers of two, indices are masked
+#define COM_TX_Buffer_Size    1024
+#define COM_TX_BUFFER_FULL  0x1F00
+#define COM_RX_BUFFER_EMPTY 0x1E00
+
+#define UART_IRQ	(1 << 29)		// AUX interrupt in IRQ_PEND1
+
+// baud = 250MHz / (8 * (UART_BAUD_REG + 1)), 67 gives 460800 -0.27%,
+// enough for the 24 byte telemetry frame every 1.25ms tick
+#define UART_BAUD_REG	67
+
+typedef struct {
+	unsigned int rx_overflow;	// bytes dropped, RX ring full
+	unsigned int tx_overflow;	// bytes refused, TX ring full
+} UartStats;
+
+extern volatile UartStats uart_stats;
+
+void uart_init(void);
+int  uart_getc(void);
+int  uart_putc(int);
+void uart_puts(char *);
+int  uart_write(const void *, int);
+int  uart_tx_room(void);
+void uart_put_line(const char *, const char *);
+void uart_isr(void);
+
+#endif /* UART_H */